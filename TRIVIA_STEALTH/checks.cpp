@@ -0,0 +1,820 @@
+#include "render.h"
+#if defined(__unix__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+//  Headless Checks 
+// Scripted input: wander in straight runs, sprint and work doors now and then, answer quizzes at random
+PlayerInput ScriptedInput(MazeRng& r, int& heading, int& runLeft) {
+    PlayerInput in = {};
+    in.quizChoice = -1;
+    if (runLeft-- <= 0) {
+        heading = (int)(r.Next() % 4);
+        runLeft = 5 + (int)(r.Next() % 40);
+    }
+    in.up = heading == 0;
+    in.down = heading == 1;
+    in.left = heading == 2;
+    in.right = heading == 3;
+    in.sprint = (r.Next() % 4) == 0;
+    in.use = (r.Next() % 16) == 0;
+    if (currentState == QUIZ) in.quizChoice = (int)(r.Next() % 3);
+    in.confirm = (currentState == GAME_OVER || currentState == VICTORY);
+    return in;
+}
+
+// Runs the rules without a window for the given number of ticks and reports every
+// heap allocation made during PLAYING, FROZEN and QUIZ ticks, including the particle
+// work the window loop would do for them. Level transitions are not steady state
+// and are excluded. Returns the process exit code.
+int RunAllocCheck(long long ticks) {
+    const float dt = 1.0f / 60.0f;
+    MazeRng r(12345);
+    int heading = 0;
+    int runLeft = 0;
+    long long steadyTicks = 0;
+    long long levels = 0;
+    if (publishState && !OpenStateStream()) return 1;
+
+    levelPipeline.Start();
+    levelPipeline.Request(NextLevelRecipe());
+    ResetGameNow();
+    particles.Init();
+    levels++;
+
+    // Warm-up lets containers reach their working capacity before counting starts
+    for (int i = 0; i < 600; i++) UpdateGame(ScriptedInput(r, heading, runLeft), dt);
+    memset(allocCounters, 0, sizeof(allocCounters));
+
+    for (long long t = 0; t < ticks; t++) {
+        PlayerInput input = ScriptedInput(r, heading, runLeft);
+        bool steady = currentState == PLAYING || currentState == FROZEN || currentState == QUIZ;
+        allocPhase = steady ? ALLOC_SIM : ALLOC_NONE;
+        StepGame(input, dt);
+        allocPhase = steady ? ALLOC_DRAW : ALLOC_NONE; // Effects as the window loop would show them
+        UpdateParticles(dt);
+        particles.Build();
+        allocPhase = ALLOC_NONE;
+        steadyTicks += steady;
+
+        if (currentState == MENU) {
+            ResetGameNow();
+            levels++;
+        }
+    }
+
+    levelPipeline.Stop();
+    particles.Unload();
+    if (statePublisher.Active()) { // --publish-state streams the scripted run too
+        statePublisher.PrintStats();
+        statePublisher.Close();
+    }
+    printf("Alloc check: %lld ticks (%lld steady) over %lld levels\n", ticks, steadyTicks, levels);
+    PrintAllocCounters();
+    if (noise.emitted) printf("Noise: %lld sprint steps, %.1f tiles touched per step\n", noise.emitted, (double)noise.tilesTouched / noise.emitted);
+    if (particles.spawned) printf("Particles: %lld spawned\n", particles.spawned);
+    bool ok = allocCounters[ALLOC_SIM].count == 0 && allocCounters[ALLOC_DRAW].count == 0;
+    printf("%s\n", ok ? "PASS: no steady-state heap allocations" : "FAIL: steady-state heap allocations");
+    return ok ? 0 : 1;
+}
+
+// Plays scripted key presses through the input buffer on a virtual clock. Presses land
+// at random moments inside a frame and are stamped with that moment, so the figures
+// include the wait for the next poll. A move must follow its press within the cadence
+// rounded up to whole ticks, plus one tick for the poll.
+const int LATENCY_MIN_SAMPLES = 500; // Per cadence
+
+int RunLatencyCheck(double seconds) {
+    const double dt = 1.0 / 60.0;
+    const int arrows[4] = { KEY_UP, KEY_DOWN, KEY_LEFT, KEY_RIGHT };
+    MazeRng r(4242);
+    double nextEvent = 0.5;
+    int heldArrow = -1;
+    bool sprint = false;
+
+    // Same levels and dice every run, so the sample counts repeat
+    mazeSettings.seed = 1;
+    rng = MazeRng(mazeSettings.seed);
+    levelPipeline.Start();
+    levelPipeline.Request(NextLevelRecipe());
+    levelPipeline.WaitUntilBuilt();
+    currentState = MENU;
+    inputBuffer.Push(KEY_ENTER, true, 0.0);
+
+    for (double t = dt; t < seconds; t += dt) {
+        // Scripted presses: taps of 20-200 ms with 30-300 ms gaps, sprinting half the time
+        while (nextEvent <= t) {
+            if (heldArrow < 0) {
+                if (r.Chance(0.5f) != sprint) {
+                    sprint = !sprint;
+                    inputBuffer.Push(KEY_LEFT_SHIFT, sprint, nextEvent);
+                }
+                heldArrow = arrows[r.Next() % 4];
+                inputBuffer.Push(heldArrow, true, nextEvent);
+                nextEvent += 0.02 + (r.Next() % 1000) * 0.00018;
+            } else {
+                inputBuffer.Push(heldArrow, false, nextEvent);
+                heldArrow = -1;
+                nextEvent += 0.03 + (r.Next() % 1000) * 0.00027;
+            }
+        }
+        if (currentState == QUIZ) inputBuffer.Push(KEY_ONE, true, t);
+        if (currentState == GAME_OVER || currentState == VICTORY || currentState == MENU) inputBuffer.Push(KEY_ENTER, true, t);
+        // The worker runs on the wall clock; without this the virtual clock sits in the menu
+        if (currentState == MENU) levelPipeline.WaitUntilBuilt();
+
+        UpdateGame(inputBuffer.Consume(t), (float)dt);
+    }
+    levelPipeline.Stop();
+
+    inputLatency.Print();
+    bool ok = true;
+    for (int c = 0; c < CADENCE_COUNT; c++) {
+        Cadence cad = (Cadence)c;
+        double bound = ceil(CADENCE_DELAY[c] / dt - 1e-6) * dt + dt;
+        // A p99 from a few dozen moves is just the slowest one
+        bool enough = inputLatency.Count(cad) >= LATENCY_MIN_SAMPLES;
+        bool pass = enough && inputLatency.Percentile(cad, 0.99f) <= bound + 1e-6;
+        printf("%s: %s p99 within %.1f ms%s\n", pass ? "PASS" : "FAIL", CADENCE_NAMES[c], bound * 1000.0,
+               enough ? "" : " (too few moves to tell)");
+        ok = ok && pass;
+    }
+    return ok ? 0 : 1;
+}
+
+// Plays scripted ticks while recording, then jumps back and checks that every restored
+// tick matches what was captured, byte for byte, and that replaying the same inputs
+// from there lands on the same states. Also times capture and restore.
+int RunSnapshotCheck(int ticks) {
+    const float dt = 1.0f / 60.0f;
+    const int REWIND = 200;
+    MazeRng r(777);
+    int heading = 0;
+    int runLeft = 0;
+
+    levelPipeline.Start();
+    levelPipeline.Request(NextLevelRecipe());
+    ResetGameNow();
+
+    // Reference states and inputs for the last REWIND ticks
+    std::vector<unsigned char> states((size_t)REWIND * SNAPSHOT_MAX_BYTES);
+    std::vector<size_t> sizes(REWIND);
+    std::vector<PlayerInput> inputs(REWIND);
+    std::vector<unsigned char> scratch(SNAPSHOT_MAX_BYTES);
+    auto StateAt = [&](long long tick) { return &states[(size_t)(tick % REWIND) * SNAPSHOT_MAX_BYTES]; };
+    auto Matches = [&](long long tick) {
+        ByteWriter w = { scratch.data(), SNAPSHOT_MAX_BYTES };
+        SaveGameState(w);
+        return w.size == sizes[tick % REWIND] && memcmp(scratch.data(), StateAt(tick), w.size) == 0;
+    };
+
+    double captureSeconds = 0;
+    long long captures = 0;
+    int mismatches = 0;
+    long long levels = 1;
+    // Keeps going past the requested ticks until the current level has a full window
+    for (int t = 0; t < ticks || (simTick < REWIND && t < ticks * 2); t++) {
+        PlayerInput input = ScriptedInput(r, heading, runLeft);
+        UpdateGame(input, dt);
+        if (currentState == MENU) {
+            ResetGameNow();
+            levels++;
+            continue;
+        }
+        auto start = std::chrono::steady_clock::now();
+        history.Capture(++simTick);
+        captureSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        captures++;
+
+        ByteWriter w = { StateAt(simTick), SNAPSHOT_MAX_BYTES };
+        SaveGameState(w);
+        sizes[simTick % REWIND] = w.size;
+        inputs[simTick % REWIND] = input;
+    }
+
+    // Walk back one tick at a time, then replay forward from the oldest reachable tick
+    long long newest = simTick;
+    long long oldest = max(history.OldestTick(), newest - REWIND + 1);
+    double restoreSeconds = 0;
+    long long restores = 0;
+    for (long long tick = newest; tick >= oldest; tick--) {
+        auto start = std::chrono::steady_clock::now();
+        bool ok = history.Restore(tick);
+        restoreSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        restores++;
+        if (!ok || !Matches(tick)) mismatches++;
+    }
+    simTick = oldest;
+    for (long long tick = oldest + 1; tick <= newest; tick++) {
+        UpdateGame(inputs[tick % REWIND], dt);
+        history.Capture(++simTick);
+        if (!Matches(tick)) mismatches++;
+    }
+    levelPipeline.Stop();
+
+    printf("Snapshot check: %lld captures over %lld levels, %lld restores\n", captures, levels, restores);
+    printf("  average entry: %.0f bytes (full state %zu bytes)\n",
+           captures ? (double)history.bytesCaptured / captures : 0.0, sizes[newest % REWIND]);
+    printf("  capture: %.2f us   restore: %.2f us\n",
+           captures ? captureSeconds * 1e6 / captures : 0.0, restores ? restoreSeconds * 1e6 / restores : 0.0);
+    bool ok = mismatches == 0 && restores > 1;
+    printf("%s: %d mismatched ticks\n", ok ? "PASS" : "FAIL", mismatches);
+    return ok ? 0 : 1;
+}
+
+// Puts both thieves on one diamond, then on one nugget, and checks that each is
+// taken once: one diamond off the count, one question drawn, one pickup gone.
+bool CheckSharedPickup() {
+    if (currentState == MENU) ResetGameNow();
+    World& world = level->world;
+    for (int p = 0; p < playerCount; p++) world.Remove<Freeze>(level->players[p]);
+
+    bool ok = true;
+    for (int kind : { PICKUP_DIAMOND, PICKUP_NUGGET }) {
+        Position at = { -1, -1 };
+        world.Each<Position, Pickup>([&](int n, const EntityHandle*, Position* pos, Pickup* pickup) {
+            for (int i = 0; i < n; i++) {
+                if (pickup[i].kind == kind) at = pos[i];
+            }
+        });
+        if (at.x < 0) continue;
+        for (int p = 0; p < playerCount; p++) *world.Get<Position>(level->players[p]) = at;
+        if (questionIndices.empty()) ShuffleQuestions();
+
+        int pickups = world.Count<Pickup>();
+        int diamonds = level->diamondsLeft;
+        size_t questions = questionIndices.size();
+        currentState = PLAYING;
+        PickupSystem(world);
+        world.Flush();
+        ok = ok && world.Count<Pickup>() == pickups - 1;
+        if (kind == PICKUP_DIAMOND) ok = ok && level->diamondsLeft == diamonds - 1;
+        else ok = ok && questionIndices.size() == questions - 1 && currentState == QUIZ;
+    }
+    printf("Shared pickup: both thieves on one diamond and one nugget, %s\n", ok ? "each taken once" : "counted twice");
+    return ok;
+}
+
+// Plays both seats of a co-op game as two processes over loopback, with scripted
+// inputs and a tenth of the packets dropped. Fails if the peers ever disagree on a
+// state hash or stop advancing.
+int RunCoopCheck(int ticks) {
+#if defined(__unix__)
+    int port = LOCKSTEP_PORT + 2 + (int)(getpid() % 500) * 2;
+    fflush(stdout);
+    pid_t child = fork();
+    if (child < 0) {
+        perror("fork");
+        return 1;
+    }
+    int seat = child == 0 ? 1 : 0;
+
+    playerCount = 2;
+    localPlayer = seat;
+    mazeSettings.seed = 1;
+    rng = MazeRng(mazeSettings.seed);
+    if (!lockstep.Open(seat, port, 3)) {
+        printf("Co-op check: could not open UDP port %d\n", port + seat);
+        if (child == 0) exit(1);
+        waitpid(child, nullptr, 0);
+        return 1;
+    }
+    lockstep.dropRate = 0.1f;
+    MazeRng script(100 + seat);
+    int heading = 0;
+    int runLeft = 0;
+
+    levelPipeline.Start();
+    levelPipeline.Request(NextLevelRecipe());
+    currentState = MENU;
+    auto start = std::chrono::steady_clock::now();
+    auto Elapsed = [&] { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+    double lastProgress = 0;
+    uint32_t progress = 0;
+
+    // Runs until the peer's hash for the final tick has been compared
+    const uint32_t last = (uint32_t)ticks;
+    while (lockstep.executed < last || lockstep.lastHashChecked < last) {
+        double now = Elapsed();
+        lockstep.Receive(now);
+        if (lockstep.CanSchedule()) {
+            PlayerInput in = ScriptedInput(script, heading, runLeft);
+            in.confirm = in.confirm || currentState == MENU;
+            lockstep.Schedule(in, now);
+        }
+        lockstep.Send();
+
+        bool stepped = false;
+        while (lockstep.executed < last && lockstep.Ready() && LockstepCanTick()) {
+            PlayerInput inputs[MAX_PLAYERS];
+            lockstep.Next(inputs);
+            UpdateGame(inputs, LOCKSTEP_DT);
+            lockstep.Confirm(HashGameState());
+            stepped = true;
+        }
+        if (!stepped) lockstep.Wait(0.001);
+
+        if (lockstep.executed + lockstep.lastHashChecked != progress) {
+            progress = lockstep.executed + lockstep.lastHashChecked;
+            lastProgress = now;
+        } else if (now - lastProgress > 5.0) {
+            printf("Co-op check: seat %d stalled at tick %u\n", seat + 1, lockstep.executed);
+            break;
+        }
+    }
+
+    // Keep answering for a moment so the peer gets our final hash too
+    for (int i = 0; i < 50; i++) {
+        lockstep.Receive(Elapsed());
+        lockstep.Send();
+        lockstep.Wait(0.002);
+    }
+    double seconds = Elapsed();
+    lockstep.Close();
+
+    bool ok = lockstep.executed >= last && lockstep.lastHashChecked >= last && lockstep.desyncs == 0;
+    if (child != 0) ok = CheckSharedPickup() && ok;
+    levelPipeline.Stop();
+    if (child == 0) {
+        lockstep.PrintStats(seconds);
+        fflush(stdout);
+        exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    lockstep.PrintStats(seconds);
+    ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    printf("%s: %d lockstep ticks, %s\n", ok ? "PASS" : "FAIL", ticks, ok ? "no desyncs" : "peers disagreed, stalled or double-counted a pickup");
+    return ok ? 0 : 1;
+#else
+    printf("Co-op check needs BSD sockets and fork()\n");
+    return 1;
+#endif
+}
+
+// Keeps the particle pool full for a number of frames: bursts refill whatever died,
+// then the pool is moved and its mesh filled as a frame would. Fails if the pool
+// ever allocates or does not stay full.
+int RunParticleCheck(int frames) {
+    const float dt = 1.0f / 60.0f;
+    particles.Init();
+    MazeRng r(2024);
+    double updateSeconds = 0;
+    double buildSeconds = 0;
+    int fullFrames = 0;
+    memset(allocCounters, 0, sizeof(allocCounters));
+    allocPhase = ALLOC_DRAW;
+    for (int f = 0; f < frames; f++) {
+        while (particles.Live() < PARTICLE_CAPACITY) {
+            Vector2 at = { (float)(r.Next() % 4000), (float)(r.Next() % 4000) };
+            particles.Burst(at, 500, COL_DIAMOND, 220.0f, 0.5f + (r.Next() % 100) / 100.0f, 5.0f);
+        }
+        fullFrames += particles.Live() == PARTICLE_CAPACITY;
+        auto start = std::chrono::steady_clock::now();
+        particles.Update(dt);
+        auto built = std::chrono::steady_clock::now();
+        particles.Build();
+        auto end = std::chrono::steady_clock::now();
+        updateSeconds += std::chrono::duration<double>(built - start).count();
+        buildSeconds += std::chrono::duration<double>(end - built).count();
+    }
+    allocPhase = ALLOC_NONE;
+    particles.Unload();
+
+    printf("Particle check: %d frames at %d live, %lld spawned\n", frames, PARTICLE_CAPACITY, particles.spawned);
+    printf("  update: %.3f ms   mesh fill: %.3f ms per frame\n", updateSeconds * 1000.0 / frames, buildSeconds * 1000.0 / frames);
+    PrintAllocCounters();
+    bool ok = allocCounters[ALLOC_DRAW].count == 0 && fullFrames == frames;
+    printf("%s\n", ok ? "PASS: pool stayed full without heap allocations" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+// Records the playfield and HUD from render snapshots, as the window loop does, during scripted play,
+// then asks the counting backend how many draw calls raylib would need for the list
+// in recording order and sorted. Without a GL context particles are not recorded.
+// Optionally writes the last frame's sorted list to a file.
+int RunRenderCheck(int frames, const char* dumpPath) {
+    const float dt = 1.0f / 60.0f;
+    MazeRng r(777);
+    int heading = 0;
+    int runLeft = 0;
+
+    levelPipeline.Start();
+    levelPipeline.Request(NextLevelRecipe());
+    ResetGameNow();
+    particles.Init();
+    static RenderSnapshot snap;
+
+    long long commands = 0;
+    long long callsRecorded = 0;
+    long long callsSorted = 0;
+    int maxCommands = 0;
+    int dropped = 0;
+    int worse = 0;
+    int recordedFrames = 0;
+    double recordSeconds = 0;
+    double sortSeconds = 0;
+    memset(allocCounters, 0, sizeof(allocCounters));
+
+    for (int t = 0; recordedFrames < frames && t < frames * 20; t++) {
+        StepGame(ScriptedInput(r, heading, runLeft), dt);
+        UpdateParticles(dt);
+        if (currentState == MENU) ResetGameNow();
+        if (currentState != PLAYING && currentState != FROZEN) continue;
+
+        allocPhase = ALLOC_SIM;
+        CaptureRenderSnapshot(snap);
+        allocPhase = ALLOC_DRAW;
+        auto start = std::chrono::steady_clock::now();
+        drawList.Begin();
+        DrawWorld(snap);
+        DrawUI(snap);
+        auto recorded = std::chrono::steady_clock::now();
+        drawList.Sort();
+        auto end = std::chrono::steady_clock::now();
+        allocPhase = ALLOC_NONE;
+
+        recordSeconds += std::chrono::duration<double>(recorded - start).count();
+        sortSeconds += std::chrono::duration<double>(end - recorded).count();
+        int before = CountDrawCalls(drawList, false);
+        int after = CountDrawCalls(drawList, true);
+        callsRecorded += before;
+        callsSorted += after;
+        worse += after > before;
+        commands += drawList.Count();
+        maxCommands = max(maxCommands, drawList.Count());
+        dropped += drawList.Dropped();
+        recordedFrames++;
+    }
+
+    levelPipeline.Stop();
+    particles.Unload();
+    if (recordedFrames == 0) {
+        printf("FAIL: no frames recorded\n");
+        return 1;
+    }
+    if (dumpPath) {
+        FILE* out = fopen(dumpPath, "w");
+        if (out) {
+            WriteDrawList(drawList, out);
+            fclose(out);
+            printf("Last frame written to %s\n", dumpPath);
+        }
+    }
+
+    double n = recordedFrames;
+    printf("Render check: %d frames, %.0f commands per frame (max %d of %d)\n", recordedFrames, commands / n, maxCommands, DRAW_CAPACITY);
+    printf("  draw calls: %.1f in recording order, %.1f sorted\n", callsRecorded / n, callsSorted / n);
+    printf("  record: %.1f us   sort: %.1f us per frame\n", recordSeconds * 1e6 / n, sortSeconds * 1e6 / n);
+    PrintAllocCounters();
+    bool ok = dropped == 0 && worse == 0 && allocCounters[ALLOC_DRAW].count == 0;
+    printf("%s\n", ok ? "PASS: sorting never added draw calls, nothing dropped or allocated" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+// Drives the governor with a model of a machine instead of real frames: CPU cost
+// per quality tier, GPU cost growing with the pixels drawn, and the frame limiter
+// holding fast frames at the budget. Each scenario must end with at least 95% of
+// its last ten seconds on budget; the last one also has to climb back to full
+// scale and quality once its load drops.
+struct GovernorScenario {
+    const char* name;
+    float cpuMs;       // At high quality
+    float gpuMs;       // At high quality and full scale
+    float laterGpuMs;  // GPU cost after the first half, 0 = unchanged
+};
+
+int RunGovernorCheck(int seconds) {
+    const GovernorScenario scenarios[] = {
+        { "fast desktop", 3.0f, 5.0f, 0 },
+        { "weak integrated GPU", 4.0f, 28.0f, 0 },
+        { "software GL", 9.0f, 48.0f, 0 },
+        { "CPU-bound", 19.0f, 6.0f, 0 },
+        { "load drops", 4.0f, 28.0f, 8.0f },
+    };
+    const float TIER_CPU[QUALITY_COUNT] = { 0.6f, 0.8f, 1.0f };
+    const float TIER_GPU[QUALITY_COUNT] = { 0.6f, 0.8f, 1.0f };
+    const int frames = seconds * FULL_FPS;
+    MazeRng r(31337);
+    bool ok = true;
+
+    for (const GovernorScenario& sc : scenarios) {
+        RenderGovernor g;
+        int tail = 0;
+        int onBudget = 0;
+        for (int f = 0; f < frames; f++) {
+            float gpuBase = (sc.laterGpuMs > 0 && f >= frames / 2) ? sc.laterGpuMs : sc.gpuMs;
+            float jitter = 0.95f + 0.1f * (r.Next() % 1000) / 1000.0f;
+            float scale = g.Scale();
+            float cpu = sc.cpuMs * TIER_CPU[g.tier] * jitter;
+            // Pixel work shrinks with the square of the scale; the stretch back costs a little
+            float gpu = gpuBase * TIER_GPU[g.tier] * (scale * scale + (scale < 1.0f ? 0.1f : 0.0f)) * jitter;
+            float frame = max(FRAME_BUDGET_MS, max(cpu, gpu));
+            g.Update(frame, cpu);
+            if (f >= frames - 10 * FULL_FPS) {
+                tail++;
+                onBudget += frame <= FRAME_BUDGET_MS * 1.05f;
+            }
+        }
+        double share = 100.0 * onBudget / tail;
+        bool pass = share >= 95.0;
+        if (sc.laterGpuMs > 0) pass = pass && g.Scale() == 1.0f && g.tier == QUALITY_HIGH;
+        ok = ok && pass;
+        printf("  %-20s scale %.2f  quality %-6s  %5.1f%% on budget  %3d changes  %s\n", sc.name, g.Scale(), g.Quality().name,
+               share, g.changes, pass ? "ok" : "FAIL");
+    }
+    printf("Governor check: %d s per scenario at a %.2f ms budget\n", seconds, FRAME_BUDGET_MS);
+    printf("%s\n", ok ? "PASS: every scenario settled on budget" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+// Runs the simulation thread against a stand-in render thread that presses keys
+// and records frames from the snapshots at an uneven pace, sometimes stalling for
+// longer than a tick. Fails if snapshots go backwards or if the snapshot being drawn
+// changes underneath the reader (hashed before and after recording a frame). The
+// tick cadence depends on the machine, so it is only reported, unless the
+// simulation all but stopped while the render side stalled.
+uint32_t HashBytes(const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*)data;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) hash = (hash ^ p[i]) * 16777619u;
+    return hash;
+}
+
+int RunSimThreadCheck(double seconds) {
+    const int arrows[4] = { KEY_UP, KEY_DOWN, KEY_LEFT, KEY_RIGHT };
+    MazeRng r(5150);
+    int heldArrow = -1;
+
+    levelPipeline.Start();
+    levelPipeline.Request(NextLevelRecipe());
+    particles.Init();
+    currentState = MENU;
+    simThread.Start(0.0);
+
+    long long frames = 0;
+    long long recorded = 0;
+    long long torn = 0;
+    long long backwards = 0;
+    long long ticksSeen = 0;
+    long long lastTick = -1;
+    uint32_t lastSerial = 0;
+    double lastFrame = 0;
+    bool forcedEnd = false;
+    // Keeps going past SECONDS until a run ends and a second level is handed over
+    // (the 30 s guard only stops a broken handoff from hanging the check)
+    while (simThread.Now() < seconds || (lastSerial <= 1 && simThread.Now() < seconds + 30.0)) {
+        double now = simThread.Now();
+
+        // Scripted play may survive the whole run: end it with the thread paused and the
+        // next level built, so the handoff below happens on the next few key presses
+        if (now >= seconds && lastSerial <= 1 && !forcedEnd) {
+            simThread.Stop();
+            levelPipeline.WaitUntilBuilt();
+            if (currentState != MENU) currentState = GAME_OVER;
+            forcedEnd = true;
+            simThread.Start(now);
+        }
+
+        // Render stand-in: a frame of 2-20 ms, and a 50 ms stall now and then
+        int workMs = (r.Next() % 50 == 0) ? 50 : 2 + (int)(r.Next() % 19);
+        const RenderSnapshot& snap = simThread.Latest();
+        if (snap.levelSerial < lastSerial || (snap.levelSerial == lastSerial && snap.tick < lastTick)) backwards++;
+        if (snap.levelSerial != lastSerial || snap.tick != lastTick) ticksSeen++;
+        lastSerial = snap.levelSerial;
+        lastTick = snap.tick;
+
+        // Keys as a player would press them, stamped on the simulation clock
+        if (snap.state == MENU || snap.state == GAME_OVER || snap.state == VICTORY) {
+            inputBuffer.Push(KEY_ENTER, true, now);
+            inputBuffer.Push(KEY_ENTER, false, now);
+        } else if (snap.state == QUIZ) {
+            inputBuffer.Push(KEY_ONE + (int)(r.Next() % 3), true, now);
+        } else if (r.Next() % 4 == 0) {
+            if (heldArrow >= 0) inputBuffer.Push(heldArrow, false, now);
+            heldArrow = arrows[r.Next() % 4];
+            inputBuffer.Push(heldArrow, true, now);
+        }
+
+        uint32_t before = HashBytes(&snap, sizeof(snap));
+        SyncRenderResources(snap);
+        UpdateParticles((float)(now - lastFrame));
+        lastFrame = now;
+        if (snap.state == PLAYING || snap.state == FROZEN) {
+            drawList.Begin();
+            DrawWorld(snap);
+            DrawUI(snap);
+            drawList.Sort();
+            recorded++;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(workMs));
+        if (HashBytes(&snap, sizeof(snap)) != before) torn++;
+        frames++;
+    }
+
+    simThread.Stop();
+    UnloadRenderResources();
+    levelHandoff.ReleaseAll();
+    levelPipeline.Stop();
+    particles.Unload();
+
+    double elapsed = simThread.Now();
+    double expected = elapsed / SIM_DT;
+    long long ticks = simThread.ticks.load();
+    printf("Sim thread check: %.1f s, %lld ticks (%.0f expected), %lld frames (%lld recorded), %u levels\n",
+           elapsed, ticks, expected, frames, recorded, levelHandoff.serial);
+    printf("  snapshots drawn: %lld distinct, %lld went backwards, %lld changed while drawn\n", ticksSeen, backwards, torn);
+    printf("  tick cadence: %.1f%% of real time, skipped ahead %lld times\n", 100.0 * ticks / expected, simThread.skips.load());
+    bool ok = ticks >= expected * 0.5 && backwards == 0 && torn == 0 && levelHandoff.serial > 1;
+    if (forcedEnd) printf("  no run ended in time, so the check ended one\n");
+    if (levelHandoff.serial <= 1) printf("  no level was handed over\n");
+    printf("%s\n", ok ? "PASS: every snapshot arrived in order and stayed whole" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+const double MAZE_BUDGET_MS = 10.0; // GenerateMaze on a 1024x1024 map; larger maps scale it by area
+
+// Generates the same maze several times and fails if even the fastest run is over
+// budget (the others mostly measure whatever else the machine is doing), or if any
+// floor tile cannot be reached from the spawn. Also times one full
+// LoadLevel of that size, which is reported only.
+int RunMazeCheck(int cols, int rows, int runs) {
+    MazeSettings settings;
+    settings.cols = cols;
+    settings.rows = rows;
+    settings.seed = 1024;
+    LevelArena scratch;
+    scratch.Reserve(LevelArenaBytes(MazeCols(settings), MazeRows(settings)));
+    TileGrid grid;
+
+    vector<double> ms;
+    for (int i = 0; i < runs; i++) {
+        scratch.Reset();
+        grid.Resize(scratch, MazeCols(settings), MazeRows(settings), TILE_WALL);
+        auto start = std::chrono::steady_clock::now();
+        GenerateMaze(grid, scratch, settings);
+        ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(ms.begin(), ms.end());
+    double median = ms[ms.size() / 2];
+    double budget = MAZE_BUDGET_MS * max(1.0, (double)grid.cols * grid.rows / (1024.0 * 1024.0));
+
+    LevelRecipe recipe;
+    recipe.generated = true;
+    recipe.maze = settings;
+    Level* lvl = new Level;
+    auto start = std::chrono::steady_clock::now();
+    LoadLevel(*lvl, recipe);
+    double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    size_t floor = 0;
+    for (unsigned char tile : lvl->grid.cells) floor += tile != TILE_WALL;
+    size_t reachable = lvl->reachableTiles.size();
+    int farthest = reachable ? lvl->spawnDistance[lvl->reachableTiles.back()] : 0;
+    delete lvl;
+
+    printf("Maze check: %dx%d, %d runs\n", grid.cols, grid.rows, runs);
+    printf("  generate: min %.2f ms, median %.2f ms, max %.2f ms\n", ms.front(), median, ms.back());
+    printf("  full LoadLevel: %.1f ms; %zu of %zu floor tiles reachable, farthest %d steps from the spawn\n",
+           loadMs, reachable, floor, farthest);
+    bool ok = ms.front() <= budget && reachable == floor;
+    printf("%s: fastest run within %.0f ms, %s\n", ok ? "PASS" : "FAIL", budget,
+           reachable == floor ? "every floor tile reachable" : "unreachable floor tiles");
+    return ok ? 0 : 1;
+}
+
+// Opens and closes random doors on a 201x201 maze and compares every repaired route
+// field with one built from scratch, timing both. Fails on any difference.
+int RunDoorCheck(int toggles) {
+    LevelRecipe recipe;
+    recipe.generated = true;
+    recipe.maze.cols = 201;
+    recipe.maze.rows = 201;
+    recipe.maze.seed = 4242;
+    Level* lvl = new Level;
+    LoadLevel(*lvl, recipe);
+    const TileGrid& grid = lvl->grid;
+    const size_t n = grid.cells.size();
+    if (lvl->doors.empty()) {
+        printf("FAIL: maze has no doors\n");
+        delete lvl;
+        return 1;
+    }
+
+    LevelArena scratch;
+    scratch.Reserve(n * (2 * sizeof(FieldDistance) + 1) + n * (2 * sizeof(int) + sizeof(FieldDistance)) + 64);
+    DistanceField fresh;
+    fresh.Init(scratch, n);
+    FieldQueue queue;
+    queue.Init(scratch, n);
+
+    long long settledBefore = 0;
+    for (const auto& field : lvl->routeFields) settledBefore += field.settled;
+
+    MazeRng r(99);
+    double repairSeconds = 0;
+    double rebuildSeconds = 0;
+    long long applied = 0;
+    long long refused = 0;
+    int mismatches = 0;
+    for (int t = 0; t < toggles; t++) {
+        int tile = lvl->doors[r.Next() % lvl->doors.size()];
+        auto start = std::chrono::steady_clock::now();
+        bool toggled = ToggleDoor(*lvl, tile, false);
+        repairSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!toggled) {
+            refused++;
+            continue;
+        }
+        applied++;
+
+        for (const auto& field : lvl->routeFields) {
+            memcpy(fresh.source, field.source, n);
+            start = std::chrono::steady_clock::now();
+            fresh.Build(grid, queue);
+            rebuildSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (memcmp(fresh.g, field.g, n * sizeof(FieldDistance)) != 0) mismatches++;
+        }
+    }
+
+    long long settled = -settledBefore;
+    for (const auto& field : lvl->routeFields) settled += field.settled;
+    int closed = 0;
+    for (int tile : lvl->doors) closed += grid.cells[tile] == TILE_DOOR;
+    double repair = applied ? repairSeconds * 1e6 / applied : 0.0;
+    double rebuild = applied ? rebuildSeconds * 1e6 / applied : 0.0;
+
+    printf("Door check: %dx%d maze, %zu doors, %zu route fields\n", grid.cols, grid.rows, lvl->doors.size(), lvl->routeFields.size());
+    printf("  %lld toggles (%lld refused, occupied), %d doors closed at the end\n", applied, refused, closed);
+    printf("  repair: %.2f us per toggle, %.0f tiles settled\n", repair, applied ? (double)settled / applied : 0.0);
+    printf("  full rebuild: %.2f us per toggle (%.0fx), %zu tiles per field\n", rebuild, repair > 0 ? rebuild / repair : 0.0, n);
+    delete lvl;
+
+    bool ok = mismatches == 0 && applied > 0;
+    printf("%s: %d mismatched fields\n", ok ? "PASS" : "FAIL", mismatches);
+    return ok ? 0 : 1;
+}
+
+// Runs one check and returns its exit code; ctest runs each of them (CMakeLists.txt).
+// Generator options (--maze [WxH] --seed N --loops R --dead-ends R --doors R) apply
+// to the checks named after them.
+int main(int argc, char* argv[]) {
+    std::random_device rd;
+    rng = MazeRng(rd());
+    mazeSettings.seed = rd();
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--maze") == 0) {
+            useGeneratedMaze = true;
+            if (i + 1 < argc && sscanf(argv[i + 1], "%dx%d", &mazeSettings.cols, &mazeSettings.rows) == 2) i++;
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) mazeSettings.seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) mazeSettings.loopRatio = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--dead-ends") == 0 && i + 1 < argc) mazeSettings.deadEndRatio = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--doors") == 0 && i + 1 < argc) mazeSettings.doorRatio = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--alloc-check") == 0) {
+            long long ticks = (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) ? atoll(argv[++i]) : 100000;
+            return RunAllocCheck(ticks);
+        }
+        else if (strcmp(argv[i], "--latency-check") == 0) {
+            double seconds = (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) ? atof(argv[++i]) : 1200.0;
+            return RunLatencyCheck(seconds);
+        }
+        else if (strcmp(argv[i], "--coop-check") == 0) {
+            int ticks = (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) ? atoi(argv[++i]) : 20000;
+            return RunCoopCheck(ticks);
+        }
+        else if (strcmp(argv[i], "--snapshot-check") == 0) {
+            int ticks = (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) ? atoi(argv[++i]) : 20000;
+            return RunSnapshotCheck(ticks);
+        }
+        else if (strcmp(argv[i], "--door-check") == 0) {
+            int toggles = (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) ? atoi(argv[++i]) : 500;
+            return RunDoorCheck(toggles);
+        }
+        else if (strcmp(argv[i], "--governor-check") == 0) {
+            int seconds = (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) ? atoi(argv[++i]) : 120;
+            return RunGovernorCheck(seconds);
+        }
+        else if (strcmp(argv[i], "--sim-thread-check") == 0) {
+            double seconds = (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) ? atof(argv[++i]) : 10.0;
+            return RunSimThreadCheck(seconds);
+        }
+        else if (strcmp(argv[i], "--render-check") == 0) {
+            int frames = (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) ? atoi(argv[++i]) : 2000;
+            const char* dump = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : nullptr;
+            return RunRenderCheck(frames, dump);
+        }
+        else if (strcmp(argv[i], "--maze-check") == 0) {
+            int cols = 1024, rows = 1024;
+            if (i + 1 < argc && sscanf(argv[i + 1], "%dx%d", &cols, &rows) == 2) i++;
+            return RunMazeCheck(cols, rows, 21);
+        }
+        else if (strcmp(argv[i], "--particle-check") == 0) {
+            int frames = (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) ? atoi(argv[++i]) : 600;
+            return RunParticleCheck(frames);
+        }
+    }
+    printf("Usage: trivia_checks [generator options] --<name>-check [ARGS]\n");
+    return 2;
+}
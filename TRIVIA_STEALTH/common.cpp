@@ -0,0 +1,53 @@
+#include "common.h"
+
+//  Startup Timeline 
+const std::chrono::steady_clock::time_point PROCESS_START = std::chrono::steady_clock::now();
+StartupTimeline startup;
+
+//  Allocation Tracking 
+AllocCounters allocCounters[ALLOC_PHASE_COUNT];
+thread_local int allocPhase = ALLOC_NONE;
+bool allocTrack = false;
+
+void* TrackedAlloc(size_t size) {
+    if (allocPhase != ALLOC_NONE) {
+        allocCounters[allocPhase].count++;
+        allocCounters[allocPhase].bytes += (long long)size;
+    }
+    return malloc(size ? size : 1);
+}
+
+// GCC pairs the inlined free() with operator new and warns; the pairing is intended here
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void TrackedFree(void* p) {
+    free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+void* operator new(size_t size) {
+    void* p = TrackedAlloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size) {
+    void* p = TrackedAlloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return TrackedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return TrackedAlloc(size); }
+void operator delete(void* p) noexcept { TrackedFree(p); }
+void operator delete[](void* p) noexcept { TrackedFree(p); }
+void operator delete(void* p, size_t) noexcept { TrackedFree(p); }
+void operator delete[](void* p, size_t) noexcept { TrackedFree(p); }
+
+void PrintAllocCounters() {
+    for (int i = 0; i < ALLOC_PHASE_COUNT; i++) {
+        printf("Allocations in %s: %lld (%lld bytes)\n", ALLOC_PHASE_NAMES[i], allocCounters[i].count, allocCounters[i].bytes);
+    }
+}
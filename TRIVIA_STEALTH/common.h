@@ -0,0 +1,154 @@
+// Constants, shared enums and plain structs used by every part of the game, plus the
+// startup timeline and allocation tracking hooks.
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <array>
+#include <iterator>
+#include <ctime>
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <new>
+#include <chrono>
+#include <source_location>
+#include <bit>
+
+using namespace std;
+
+//  Constants
+const int TILE_SIZE = 60;
+const int COLS = 20;
+const int ROWS = 15;
+
+const int UI_HEIGHT = 80;
+const int SCREEN_WIDTH = COLS * TILE_SIZE;          // 1200 px
+const int SCREEN_HEIGHT = (ROWS * TILE_SIZE) + UI_HEIGHT; // 980 px
+
+// Colors
+const Color BG_COLOR = { 20, 20, 30, 255 };
+const Color COL_WALL = { 50, 50, 65, 255 };
+const Color COL_WALL_SHADOW = { 10, 10, 15, 200 };
+const Color COL_PLAYER = { 0, 228, 48, 255 };
+const Color COL_PARTNER = { 200, 122, 255, 255 }; // Second thief in co-op
+const Color COL_ENEMY_SLOW = { 230, 41, 55, 255 };
+const Color COL_ENEMY_FAST = { 255, 161, 0, 255 };
+const Color COL_DIAMOND = { 0, 240, 255, 255 };
+const Color COL_NUGGET = { 218, 165, 32, 255 }; // Goldenrod
+const Color COL_INVISIBLE = { 100, 255, 218, 100 };
+const Color COL_UI_PANEL = { 15, 15, 20, 255 };
+const Color COL_DOOR = { 150, 100, 60, 255 };
+
+//  Startup Timeline 
+// Marks from process start to the first presented frame. The start point is taken
+// while globals are initialised, before main runs.
+extern const std::chrono::steady_clock::time_point PROCESS_START;
+const double MENU_BUDGET_MS = 100.0;
+
+struct StartupTimeline {
+    static const int MAX_MARKS = 32;
+    const char* names[MAX_MARKS];
+    double at[MAX_MARKS]; // ms since PROCESS_START
+    int count = 0;
+    bool print = false;   // --startup-trace
+    bool finished = false;
+
+    void Mark(const char* name) {
+        if (finished || count == MAX_MARKS) return;
+        names[count] = name;
+        at[count] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - PROCESS_START).count();
+        count++;
+    }
+
+    // Closes the timeline; the "first frame presented" mark is the one held to the budget
+    void Finish() {
+        if (finished) return;
+        finished = true;
+        if (!print) return;
+        printf("Startup timeline (ms since process start):\n");
+        double menuAt = 0;
+        for (int i = 0; i < count; i++) {
+            printf("  %8.2f  +%7.2f  %s\n", at[i], at[i] - (i ? at[i - 1] : 0.0), names[i]);
+            if (strcmp(names[i], "first frame presented") == 0) menuAt = at[i];
+        }
+        printf("  Menu on screen after %.1f ms (%s %.0f ms budget)\n", menuAt, menuAt <= MENU_BUDGET_MS ? "within" : "OVER", MENU_BUDGET_MS);
+    }
+};
+
+extern StartupTimeline startup;
+
+//  Allocation Tracking 
+// Every C++ heap allocation goes through these hooks. When the current thread has
+// an active phase the allocation is counted against it (--alloc-track prints the
+// totals on exit, --alloc-check fails on any steady-state allocation). Other
+// threads, like the level worker, never set a phase and are not counted.
+enum AllocPhase { ALLOC_NONE = -1, ALLOC_SIM, ALLOC_DRAW, ALLOC_PHASE_COUNT };
+const char* const ALLOC_PHASE_NAMES[ALLOC_PHASE_COUNT] = { "sim", "draw" };
+
+struct AllocCounters {
+    long long count;
+    long long bytes;
+};
+
+extern AllocCounters allocCounters[ALLOC_PHASE_COUNT];
+extern thread_local int allocPhase;
+extern bool allocTrack;
+
+void PrintAllocCounters();
+
+//  Enums
+enum GameState { MENU, PLAYING, QUIZ, FROZEN, GAME_OVER, VICTORY, HELP };
+enum TileType { TILE_EMPTY = 0, TILE_WALL = 1, TILE_EXIT = 2, TILE_DOOR = 3, TILE_DOOR_OPEN = 4 }; // TILE_DOOR is closed
+
+inline bool IsDoorTile(unsigned char t) { return t == TILE_DOOR || t == TILE_DOOR_OPEN; }
+inline bool IsOpenTile(unsigned char t) { return t != TILE_WALL && t != TILE_DOOR; } // Something can stand here
+
+//  Structs
+struct GridPos {
+    int x, y;
+};
+
+// Views into string literals, so the bank is built by the compiler, not at startup
+struct Question {
+    std::string_view text;
+    std::string_view options[3];
+    int correctIndex; // 0, 1, or 2
+};
+
+// Keys sampled once per tick, so the rules never call raylib input directly
+enum Direction { DIR_NONE = -1, DIR_UP, DIR_DOWN, DIR_LEFT, DIR_RIGHT };
+constexpr int DIR_DX[4] = { 0, 0, -1, 1 };
+constexpr int DIR_DY[4] = { -1, 1, 0, 0 };
+
+const int MAX_PLAYERS = 2; // Co-op: two thieves, one set of guards
+
+struct PlayerInput {
+    bool up, down, left, right;
+    bool sprint;
+    bool confirm;            // ENTER
+    bool help;               // H
+    bool back;               // ESCAPE
+    bool rewind;             // BACKSPACE, held
+    bool use;                // E: open or close the doors next to the thief
+    int quizChoice = -1;     // 0-2, or -1
+    int pressedDir = DIR_NONE; // Newest arrow key pressed since the last tick
+    double pressedAt = 0;    // When that press was seen (GetTime clock)
+    double time = 0;         // When this input was handed to the tick
+};
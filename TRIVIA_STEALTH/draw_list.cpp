@@ -0,0 +1,149 @@
+#include "draw_list.h"
+
+//  Render Stats 
+RenderStats renderStats;
+
+//  Draw Commands 
+bool IsWorldLayer(int layer) { return layer >= LAYER_FLOOR && layer <= LAYER_FOG; }
+
+DrawList drawList;
+
+// Below full scale the world layers are drawn into the top-left corner of this
+// window-sized target and stretched back over the window. One allocation serves
+// every scale; at full scale the world goes straight to the window instead.
+RenderTexture2D playfieldTarget = {};
+
+void LoadPlayfieldTarget() {
+    playfieldTarget = LoadRenderTexture(SCREEN_WIDTH, SCREEN_HEIGHT);
+    SetTextureFilter(playfieldTarget.texture, TEXTURE_FILTER_BILINEAR);
+}
+
+void UnloadPlayfieldTarget() {
+    if (playfieldTarget.id) UnloadRenderTexture(playfieldTarget);
+    playfieldTarget = {};
+}
+
+void BeginPlayfield(const Camera2D& camera, float scale) {
+    if (scale >= 1.0f || !playfieldTarget.id) {
+        BeginMode2D(camera);
+        return;
+    }
+    Camera2D scaled = camera;
+    scaled.offset = Vector2Scale(camera.offset, scale);
+    scaled.zoom *= scale;
+    BeginTextureMode(playfieldTarget);
+    ClearBackground(BG_COLOR);
+    BeginMode2D(scaled);
+}
+
+void EndPlayfield(float scale) {
+    EndMode2D();
+    if (scale >= 1.0f || !playfieldTarget.id) return;
+    EndTextureMode();
+    // Render textures are stored bottom-up, hence the flipped source
+    float w = SCREEN_WIDTH * scale;
+    float h = SCREEN_HEIGHT * scale;
+    Rectangle source = { 0, playfieldTarget.texture.height - h, w, -h };
+    DrawTexturePro(playfieldTarget.texture, source, { 0, 0, (float)SCREEN_WIDTH, (float)SCREEN_HEIGHT }, { 0, 0 }, 0.0f, WHITE);
+}
+
+// raylib backend. World layers go inside the camera, at the render scale; each
+// command is measured on its own, so the F3 overlay and CSV still attribute cost
+// to source lines.
+// Most vertices a command can add to the batch. Generous on purpose: it only decides
+// whether the render stats flush before the call, and only while they are on.
+int MaxBatchVertices(const DrawList& list, const DrawCommand& c) {
+    switch ((DrawOp)c.op) {
+        case OP_ROUNDED:
+        case OP_ROUNDED_LINES: return 16 * max(c.n, 16) + 40; // raylib picks the segments itself below 4
+        case OP_CIRCLE:
+        case OP_CIRCLE_LINES: return 4 * 36;
+        case OP_POLY:
+        case OP_POLY_LINES: return 4 * c.n;
+        case OP_TEXT:
+        case OP_TEXT_EX: return 4 * (int)strlen(list.TextOf(c));
+        case OP_MESH: return 0;
+        default: return 8;
+    }
+}
+
+void SubmitDrawList(const DrawList& list, const Camera2D& camera, float scale, const Material& meshMaterial) {
+    Font font = GetFontDefault();
+    bool inWorld = false;
+
+    for (int i = 0; i < list.Count(); i++) {
+        const DrawCommand& c = list.At(i);
+        if (IsWorldLayer(c.layer) != inWorld) {
+            inWorld = !inWorld;
+            if (inWorld) BeginPlayfield(camera, scale);
+            else EndPlayfield(scale);
+        }
+        renderStats.BeginPhase(LAYER_PHASE[c.layer]);
+        if (renderStats.enabled) renderStats.Before(MaxBatchVertices(list, c));
+
+        const float* f = c.f;
+        Rectangle rect = { f[0], f[1], f[2], f[3] };
+        switch ((DrawOp)c.op) {
+            case OP_GRADIENT: DrawRectangleGradientV((int)f[0], (int)f[1], (int)f[2], (int)f[3], c.color, c.color2); break;
+            case OP_RECT: DrawRectangleRec(rect, c.color); break;
+            case OP_ROUNDED: DrawRectangleRounded(rect, f[4], c.n, c.color); break;
+            case OP_CIRCLE: DrawCircleV({ f[0], f[1] }, f[2], c.color); break;
+            case OP_POLY: DrawPoly({ f[0], f[1] }, c.n, f[2], f[3], c.color); break;
+            case OP_LINE_EX: DrawLineEx({ f[0], f[1] }, { f[2], f[3] }, f[4], c.color); break;
+            case OP_MESH:
+                // Meshes skip the batch, so whatever is queued has to go out first
+                rlDrawRenderBatchActive();
+                rlDisableBackfaceCulling();
+                DrawMesh(*c.mesh, meshMaterial, MatrixIdentity());
+                rlEnableBackfaceCulling();
+                renderStats.CountMesh(*c.mesh);
+                break;
+            case OP_TEXTURE:
+                DrawTexturePro(c.texture, { 0, 0, (float)c.texture.width, (float)c.texture.height }, rect, { 0, 0 }, 0.0f, c.color);
+                break;
+            case OP_LINE: DrawLine((int)f[0], (int)f[1], (int)f[2], (int)f[3], c.color); break;
+            case OP_RECT_LINES: DrawRectangleLines((int)f[0], (int)f[1], (int)f[2], (int)f[3], c.color); break;
+            case OP_ROUNDED_LINES: DrawRectangleRoundedLines(rect, f[4], c.n, c.color); break;
+            case OP_CIRCLE_LINES: DrawCircleLines((int)f[0], (int)f[1], f[2], c.color); break;
+            case OP_POLY_LINES: DrawPolyLines({ f[0], f[1] }, c.n, f[2], f[3], c.color); break;
+            case OP_TEXT: DrawText(list.TextOf(c), (int)f[0], (int)f[1], c.n, c.color); break;
+            case OP_TEXT_EX: DrawTextEx(font, list.TextOf(c), { f[0], f[1] }, f[2], f[3], c.color); break;
+            case OP_COUNT: break;
+        }
+        if (renderStats.enabled) renderStats.After(c.line);
+    }
+    if (inWorld) EndPlayfield(scale);
+}
+
+int CountDrawCalls(const DrawList& list, bool sorted) {
+    int calls = 0;
+    uint64_t state = UINT64_MAX;
+    bool inWorld = false;
+    for (int i = 0; i < list.Count(); i++) {
+        const DrawCommand& c = sorted ? list.At(i) : list.Recorded(i);
+        if (IsWorldLayer(c.layer) != inWorld) {
+            inWorld = !inWorld;
+            state = UINT64_MAX;
+        }
+        BatchState batch = OP_BATCH[c.op];
+        if (batch == BATCH_MESH) {
+            calls++;
+            state = UINT64_MAX;
+            continue;
+        }
+        uint64_t next = (uint64_t)batch << 32 | (batch == BATCH_TEXTURE ? c.texture.id : 0);
+        if (next != state) calls++;
+        state = next;
+    }
+    return calls;
+}
+
+void WriteDrawList(const DrawList& list, FILE* out) {
+    for (int i = 0; i < list.Count(); i++) {
+        const DrawCommand& c = list.At(i);
+        fprintf(out, "%-9s %-13s %5d #%02x%02x%02x%02x %g %g %g %g %g %d", LAYER_NAMES[c.layer], OP_NAMES[c.op], c.line,
+                c.color.r, c.color.g, c.color.b, c.color.a, c.f[0], c.f[1], c.f[2], c.f[3], c.f[4], c.n);
+        if (c.op == OP_TEXT || c.op == OP_TEXT_EX) fprintf(out, " \"%s\"", list.TextOf(c));
+        fputc('\n', out);
+    }
+}
@@ -0,0 +1,395 @@
+// Render list: draw commands recorded during a frame, sorted by layer and batch
+// state and submitted to rlgl, and the render stats that measure the result.
+#pragma once
+
+#include "common.h"
+
+//  Render Stats 
+// Debug instrumentation (F3 overlay, or --render-stats FILE for a per-frame CSV).
+// While enabled the game draws through its own rlgl batch, so every submitted draw
+// command can be measured by sampling the batch before and after it:
+//   primitives = rlBegin/rlEnd pairs (rlEnd bumps the batch depth by 1/20000)
+//   vertices   = growth of the batch's draw-call vertex counts
+//   switches   = new draw-call entries, i.e. texture or primitive-mode changes
+//   flushes    = the batch depth reset to -1, meaning it was submitted
+// A flush in the middle of a call would reset the batch and take the first part of
+// that call's counts with it, so a call that might not fit is flushed before it
+// starts (Before) and the delta around it covers the whole call.
+enum RenderPhase { PHASE_MAP, PHASE_ENTITIES, PHASE_UI, PHASE_COUNT };
+const char* const PHASE_NAMES[PHASE_COUNT] = { "map", "entities", "ui" };
+
+struct PhaseStats {
+    int primitives;
+    int vertices;
+    int switches;
+    int flushes;
+};
+
+// A source line that started a new draw call or forced a flush this frame
+struct BatchBreak {
+    int line;
+    int phase;
+    int count;
+};
+
+const float RL_DEPTH_STEP = 1.0f / 20000.0f;
+const int MAX_BATCH_BREAKS = 32;
+
+struct RenderStats {
+    bool enabled = false;
+    bool overlay = false;
+    FILE* csv = nullptr;
+    rlRenderBatch batch = {};
+    bool batchLoaded = false;
+
+    PhaseStats phases[PHASE_COUNT] = {};
+    BatchBreak breaks[MAX_BATCH_BREAKS] = {};
+    int breakCount = 0;
+    int phase = PHASE_UI;
+    long long frame = 0;
+
+    // Batch state seen after the previous wrapped call
+    float lastDepth = -1.0f;
+    int lastDraws = 1;
+    int lastVertices = 0;
+    float beforeDepth = -1.0f;
+    int beforeDraws = 1;
+    int beforeVertices = 0;
+    bool flushedBefore = false;
+
+    int BatchVertices() const {
+        int v = 0;
+        for (int i = 0; i < batch.drawCounter; i++) v += batch.draws[i].vertexCount;
+        return v;
+    }
+
+    void SetEnabled(bool on) {
+        if (on && !batchLoaded) {
+            batch = rlLoadRenderBatch(1, 8192); // Same shape as raylib's default desktop batch
+            batchLoaded = true;
+        }
+        enabled = on;
+        rlSetRenderBatchActive(on ? &batch : nullptr);
+    }
+
+    void BeginFrame() {
+        if (!enabled) return;
+        memset(phases, 0, sizeof(phases));
+        breakCount = 0;
+        lastDepth = batch.currentDepth;
+        lastDraws = batch.drawCounter;
+        lastVertices = BatchVertices();
+    }
+
+    void BeginPhase(RenderPhase p) { phase = p; }
+
+    // `vertices`: the most the coming call can add to the batch
+    void Before(int vertices) {
+        bool full = batch.drawCounter >= RL_DEFAULT_BATCH_DRAWCALLS - 2; // Text may add a texture switch and back
+        if (full) rlDrawRenderBatchActive();
+        flushedBefore = full || rlCheckRenderBatchLimit(vertices);
+        if (flushedBefore) {
+            phases[phase].flushes++;
+            lastDepth = batch.currentDepth;
+        }
+        beforeDepth = batch.currentDepth;
+        beforeDraws = batch.drawCounter;
+        beforeVertices = BatchVertices();
+        // A reset since the last wrapped call means something unwrapped
+        // (mode change, EndMode2D, ...) submitted the batch in between
+        if (beforeDepth < lastDepth) phases[phase].flushes++;
+    }
+
+    void After(int line) {
+        PhaseStats& ps = phases[phase];
+        float depth = batch.currentDepth;
+        int draws = batch.drawCounter;
+        int vertices = BatchVertices();
+        bool flushed = depth < beforeDepth; // Only if Before was told too few vertices
+
+        if (flushed) {
+            ps.flushes++;
+            ps.primitives += (int)((depth + 1.0f) / RL_DEPTH_STEP + 0.5f);
+            ps.vertices += vertices;
+            ps.switches += draws - 1;
+        } else {
+            ps.primitives += (int)((depth - beforeDepth) / RL_DEPTH_STEP + 0.5f);
+            ps.vertices += vertices - beforeVertices;
+            ps.switches += draws - beforeDraws;
+        }
+        if (flushedBefore || flushed || draws != beforeDraws) NoteBreak(line);
+
+        lastDepth = depth;
+        lastDraws = draws;
+        lastVertices = vertices;
+    }
+
+    // Meshes bypass the batch: one primitive and one draw call of their own
+    void CountMesh(const Mesh& mesh) {
+        if (!enabled) return;
+        phases[phase].primitives++;
+        phases[phase].vertices += mesh.vertexCount;
+        phases[phase].switches++;
+    }
+
+    void NoteBreak(int line) {
+        for (int i = 0; i < breakCount; i++) {
+            if (breaks[i].line == line) { breaks[i].count++; return; }
+        }
+        if (breakCount < MAX_BATCH_BREAKS) breaks[breakCount++] = { line, phase, 1 };
+    }
+
+    // Scale and tier are the governor's settings the frame was drawn with
+    void EndFrame(double frameMs, double drawMs, float scale, int tier) {
+        if (!enabled) return;
+        frame++;
+        if (csv) {
+            fprintf(csv, "%lld,%.3f,%.3f,%.2f,%d", frame, frameMs, drawMs, scale, tier);
+            for (const PhaseStats& p : phases) fprintf(csv, ",%d,%d,%d,%d", p.primitives, p.vertices, p.switches, p.flushes);
+            fputc('\n', csv);
+        }
+    }
+
+    void OpenCsv(const char* path) {
+        csv = fopen(path, "w");
+        if (!csv) return;
+        fprintf(csv, "frame,frame_ms,draw_ms,render_scale,quality");
+        for (const char* name : PHASE_NAMES) fprintf(csv, ",%s_prims,%s_verts,%s_switches,%s_flushes", name, name, name, name);
+        fputc('\n', csv);
+    }
+};
+
+extern RenderStats renderStats;
+
+//  Draw Commands 
+// Game code does not call raylib to draw. It records typed primitives into a
+// fixed command list instead, each tagged with a layer and the source line
+// that recorded it. Before submission the list is sorted by layer, then by
+// primitive type, so that e.g. all the tile rectangles go out before all the
+// outlines instead of alternating fill/line batches per tile. Recording order
+// is kept inside one (layer, primitive) group, so only different primitive
+// kinds on the same layer may swap places; layers exist to keep those apart.
+// Actors are the exception and keep their recording order: they overlap each
+// other, and each one's outline and face must land on its own body.
+// A backend then submits the sorted list to raylib, or, headless, estimates
+// its draw calls or writes it out as text.
+enum DrawLayer : uint8_t {
+    LAYER_BACKDROP,  // Screen space, under everything
+    LAYER_FLOOR,     // World space from here ...
+    LAYER_WALLS,
+    LAYER_TILES,
+    LAYER_PICKUPS,
+    LAYER_SHADOWS,
+    LAYER_ACTORS,
+    LAYER_PARTICLES,
+    LAYER_FOG,       // ... to here
+    LAYER_HUD,
+    LAYER_SCREEN,    // Menus, quiz box and end screens
+    LAYER_COUNT
+};
+const char* const LAYER_NAMES[LAYER_COUNT] = {
+    "backdrop", "floor", "walls", "tiles", "pickups", "shadows", "actors", "particles", "fog", "hud", "screen"
+};
+const RenderPhase LAYER_PHASE[LAYER_COUNT] = {
+    PHASE_MAP, PHASE_MAP, PHASE_MAP, PHASE_MAP, PHASE_ENTITIES, PHASE_ENTITIES,
+    PHASE_ENTITIES, PHASE_ENTITIES, PHASE_MAP, PHASE_UI, PHASE_UI
+};
+
+// Sort order inside a layer: fills, then meshes and textures, then outlines, then text on top
+enum DrawOp : uint8_t {
+    OP_GRADIENT, OP_RECT, OP_ROUNDED, OP_CIRCLE, OP_POLY, OP_LINE_EX,
+    OP_MESH, OP_TEXTURE,
+    OP_LINE, OP_RECT_LINES, OP_ROUNDED_LINES, OP_CIRCLE_LINES, OP_POLY_LINES,
+    OP_TEXT, OP_TEXT_EX,
+    OP_COUNT
+};
+const char* const OP_NAMES[OP_COUNT] = {
+    "gradient", "rect", "rounded", "circle", "poly", "line_ex", "mesh", "texture",
+    "line", "rect_lines", "rounded_lines", "circle_lines", "poly_lines", "text", "text_ex"
+};
+
+// What raylib's batch is doing for each primitive; a change of state ends a draw call
+enum BatchState : uint8_t { BATCH_QUADS, BATCH_TRIANGLES, BATCH_LINES, BATCH_FONT, BATCH_TEXTURE, BATCH_MESH };
+const BatchState OP_BATCH[OP_COUNT] = {
+    BATCH_QUADS, BATCH_QUADS, BATCH_QUADS, BATCH_QUADS, BATCH_QUADS, BATCH_TRIANGLES,
+    BATCH_MESH, BATCH_TEXTURE,
+    BATCH_LINES, BATCH_LINES, BATCH_LINES, BATCH_LINES, BATCH_LINES,
+    BATCH_FONT, BATCH_FONT
+};
+
+struct DrawCommand {
+    uint8_t layer;
+    uint8_t op;
+    uint16_t line;   // Source line that recorded it, for the batch-break report
+    Color color;
+    Color color2;    // Bottom colour of gradients
+    int32_t n;       // Sides, segments or font size
+    float f[6];      // Position, size, radius, rotation ... depending on op
+    union {
+        uint32_t text;        // Offset into the list's text arena
+        const Mesh* mesh;
+        Texture2D texture;
+    };
+};
+
+const int DRAW_CAPACITY = 8192;
+const int DRAW_TEXT_BYTES = 32 * 1024;
+const int DRAW_BUCKETS = (int)LAYER_COUNT * (int)OP_COUNT;
+static_assert(DRAW_CAPACITY <= 65536, "sorted order is stored as 16-bit indices");
+
+// One frame of commands. Recording mirrors raylib's own signatures with a layer
+// in front; nothing allocates, and commands past the capacity are dropped.
+class DrawList {
+    using Loc = std::source_location;
+
+public:
+    void Begin() {
+        count = 0;
+        textUsed = 0;
+        dropped = 0;
+        sorted = false;
+    }
+
+    void Rect(DrawLayer layer, Rectangle r, Color color, Loc loc = Loc::current()) {
+        if (DrawCommand* c = Add(layer, OP_RECT, color, loc)) Set(c, r.x, r.y, r.width, r.height);
+    }
+    void Rect(DrawLayer layer, int x, int y, int w, int h, Color color, Loc loc = Loc::current()) {
+        Rect(layer, { (float)x, (float)y, (float)w, (float)h }, color, loc);
+    }
+    void RectGradientV(DrawLayer layer, int x, int y, int w, int h, Color top, Color bottom, Loc loc = Loc::current()) {
+        if (DrawCommand* c = Add(layer, OP_GRADIENT, top, loc)) {
+            Set(c, (float)x, (float)y, (float)w, (float)h);
+            c->color2 = bottom;
+        }
+    }
+    void RectLines(DrawLayer layer, int x, int y, int w, int h, Color color, Loc loc = Loc::current()) {
+        if (DrawCommand* c = Add(layer, OP_RECT_LINES, color, loc)) Set(c, (float)x, (float)y, (float)w, (float)h);
+    }
+    void Rounded(DrawLayer layer, Rectangle r, float roundness, int segments, Color color, Loc loc = Loc::current()) {
+        if (DrawCommand* c = Add(layer, OP_ROUNDED, color, loc)) Set(c, r.x, r.y, r.width, r.height, roundness, segments);
+    }
+    void RoundedLines(DrawLayer layer, Rectangle r, float roundness, int segments, Color color, Loc loc = Loc::current()) {
+        if (DrawCommand* c = Add(layer, OP_ROUNDED_LINES, color, loc)) Set(c, r.x, r.y, r.width, r.height, roundness, segments);
+    }
+    void Circle(DrawLayer layer, Vector2 center, float radius, Color color, Loc loc = Loc::current()) {
+        if (DrawCommand* c = Add(layer, OP_CIRCLE, color, loc)) Set(c, center.x, center.y, radius);
+    }
+    void Circle(DrawLayer layer, int x, int y, float radius, Color color, Loc loc = Loc::current()) {
+        Circle(layer, { (float)x, (float)y }, radius, color, loc);
+    }
+    void CircleLines(DrawLayer layer, int x, int y, float radius, Color color, Loc loc = Loc::current()) {
+        if (DrawCommand* c = Add(layer, OP_CIRCLE_LINES, color, loc)) Set(c, (float)x, (float)y, radius);
+    }
+    void Poly(DrawLayer layer, Vector2 center, int sides, float radius, float rotation, Color color, Loc loc = Loc::current()) {
+        if (DrawCommand* c = Add(layer, OP_POLY, color, loc)) Set(c, center.x, center.y, radius, rotation, 0, sides);
+    }
+    void PolyLines(DrawLayer layer, Vector2 center, int sides, float radius, float rotation, Color color, Loc loc = Loc::current()) {
+        if (DrawCommand* c = Add(layer, OP_POLY_LINES, color, loc)) Set(c, center.x, center.y, radius, rotation, 0, sides);
+    }
+    void Line(DrawLayer layer, int x0, int y0, int x1, int y1, Color color, Loc loc = Loc::current()) {
+        if (DrawCommand* c = Add(layer, OP_LINE, color, loc)) Set(c, (float)x0, (float)y0, (float)x1, (float)y1);
+    }
+    void LineEx(DrawLayer layer, Vector2 a, Vector2 b, float thick, Color color, Loc loc = Loc::current()) {
+        if (DrawCommand* c = Add(layer, OP_LINE_EX, color, loc)) Set(c, a.x, a.y, b.x, b.y, thick);
+    }
+    void Mesh(DrawLayer layer, const ::Mesh& mesh, Loc loc = Loc::current()) {
+        if (DrawCommand* c = Add(layer, OP_MESH, WHITE, loc)) c->mesh = &mesh;
+    }
+    // The whole texture stretched over dest
+    void Texture(DrawLayer layer, Texture2D texture, Rectangle dest, Color tint, Loc loc = Loc::current()) {
+        if (DrawCommand* c = Add(layer, OP_TEXTURE, tint, loc)) {
+            Set(c, dest.x, dest.y, dest.width, dest.height);
+            c->texture = texture;
+        }
+    }
+    void Text(DrawLayer layer, const char* text, int x, int y, int fontSize, Color color, Loc loc = Loc::current()) {
+        if (DrawCommand* c = AddText(layer, OP_TEXT, text, color, loc)) Set(c, (float)x, (float)y, 0, 0, 0, fontSize);
+    }
+    // Default font only, which is the only font the game uses
+    void TextEx(DrawLayer layer, const char* text, Vector2 position, float fontSize, float spacing, Color color, Loc loc = Loc::current()) {
+        if (DrawCommand* c = AddText(layer, OP_TEXT_EX, text, color, loc)) Set(c, position.x, position.y, fontSize, spacing);
+    }
+
+    // Stable counting sort on (layer, op): linear, and the order array is preallocated
+    void Sort() {
+        int start[DRAW_BUCKETS] = {};
+        for (int i = 0; i < count; i++) start[Bucket(commands[i])]++;
+        int sum = 0;
+        for (int& s : start) {
+            int n = s;
+            s = sum;
+            sum += n;
+        }
+        for (int i = 0; i < count; i++) order[start[Bucket(commands[i])]++] = (uint16_t)i;
+        sorted = true;
+    }
+
+    int Count() const { return count; }
+    int Dropped() const { return dropped; }
+    // The i-th command to submit: sorted order once Sort ran, recording order before
+    const DrawCommand& At(int i) const { return commands[sorted ? order[i] : i]; }
+    const DrawCommand& Recorded(int i) const { return commands[i]; }
+    const char* TextOf(const DrawCommand& c) const { return text + c.text; }
+
+private:
+    static int Bucket(const DrawCommand& c) { return c.layer * OP_COUNT + (c.layer == LAYER_ACTORS ? 0 : c.op); }
+
+    DrawCommand* Add(DrawLayer layer, DrawOp op, Color color, const Loc& loc) {
+        if (count == DRAW_CAPACITY) {
+            dropped++;
+            return nullptr;
+        }
+        DrawCommand* c = &commands[count++];
+        c->layer = layer;
+        c->op = op;
+        c->line = (uint16_t)loc.line();
+        c->color = color;
+        c->color2 = color;
+        sorted = false;
+        return c;
+    }
+
+    // Text is copied: TextFormat results only live until a few more calls
+    DrawCommand* AddText(DrawLayer layer, DrawOp op, const char* s, Color color, const Loc& loc) {
+        size_t len = strlen(s) + 1;
+        if (textUsed + len > (size_t)DRAW_TEXT_BYTES) {
+            dropped++;
+            return nullptr;
+        }
+        DrawCommand* c = Add(layer, op, color, loc);
+        if (!c) return nullptr;
+        memcpy(text + textUsed, s, len);
+        c->text = (uint32_t)textUsed;
+        textUsed += len;
+        return c;
+    }
+
+    static void Set(DrawCommand* c, float a, float b, float d = 0, float e = 0, float g = 0, int n = 0) {
+        c->f[0] = a; c->f[1] = b; c->f[2] = d; c->f[3] = e; c->f[4] = g; c->f[5] = 0;
+        c->n = n;
+    }
+
+    DrawCommand commands[DRAW_CAPACITY];
+    uint16_t order[DRAW_CAPACITY];
+    char text[DRAW_TEXT_BYTES];
+    size_t textUsed = 0;
+    int count = 0;
+    int dropped = 0;
+    bool sorted = false;
+};
+
+extern DrawList drawList;
+
+void LoadPlayfieldTarget();
+
+void UnloadPlayfieldTarget();
+
+// meshMaterial is one of the render resources (see SyncRenderResources)
+void SubmitDrawList(const DrawList& list, const Camera2D& camera, float scale, const Material& meshMaterial);
+
+// Headless backend: the draw calls raylib would issue, from the batch state each
+// command needs. Meshes are one call each and flush the batch; so does the camera.
+int CountDrawCalls(const DrawList& list, bool sorted);
+
+// Headless backend: one line per command, in submission order, for diffing frames
+void WriteDrawList(const DrawList& list, FILE* out);
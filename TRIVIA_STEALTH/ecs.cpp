@@ -0,0 +1,163 @@
+#include "ecs.h"
+
+//  Entity Component System 
+void World::Clear() {
+    directory.Clear();
+    archetypeCount = 0;
+    pendingCount = 0;
+    for (int i = 0; i < MAX_CHUNKS; i++) freeChunks[i] = MAX_CHUNKS - 1 - i;
+    freeChunkCount = MAX_CHUNKS;
+}
+
+void World::Destroy(EntityHandle h) {
+    EntityRecord* rec = directory.Get(h);
+    if (!rec) return;
+    RemoveRow(*rec);
+    directory.Remove(h);
+}
+
+bool World::DestroyQueued(EntityHandle h) const {
+    for (int i = 0; i < pendingCount; i++) {
+        const Pending& p = pending[i];
+        if (p.component < 0 && p.entity.index == h.index && p.entity.generation == h.generation) return true;
+    }
+    return false;
+}
+
+void World::Flush() {
+    for (int i = 0; i < pendingCount; i++) {
+        if (pending[i].component < 0) Destroy(pending[i].entity);
+        else RemoveComponent(pending[i].entity, pending[i].component);
+    }
+    pendingCount = 0;
+}
+
+void World::Save(ByteWriter& w) const {
+    directory.Save(w);
+    w.Put(archetypeCount);
+    for (int a = 0; a < archetypeCount; a++) {
+        const Archetype& arch = archetypes[a];
+        w.Put(arch.signature);
+        w.Put(arch.chunkCount);
+        for (int c = 0; c < arch.chunkCount; c++) {
+            int rows = arch.chunkRows[c];
+            const unsigned char* base = chunkData[arch.chunkIds[c]];
+            w.Put((uint8_t)arch.chunkIds[c]);
+            w.Put((uint16_t)rows);
+            w.Bytes(base, rows * sizeof(EntityHandle));
+            for (int k = 0; k < COMP_COUNT; k++) {
+                if (arch.offset[k] >= 0) w.Bytes(base + arch.offset[k], rows * COMPONENT_SIZE[k]);
+            }
+        }
+    }
+    w.Put(freeChunkCount);
+    w.Bytes(freeChunks, freeChunkCount * sizeof(int));
+}
+
+void World::Load(ByteReader& r) {
+    directory.Load(r);
+    int archetypesSaved = r.Get<int>();
+    archetypeCount = 0;
+    pendingCount = 0;
+    for (int a = 0; a < archetypesSaved; a++) {
+        Archetype& arch = archetypes[FindArchetype(r.Get<Signature>())];
+        arch.chunkCount = r.Get<int>();
+        for (int c = 0; c < arch.chunkCount; c++) {
+            arch.chunkIds[c] = r.Get<uint8_t>();
+            int rows = arch.chunkRows[c] = r.Get<uint16_t>();
+            unsigned char* base = chunkData[arch.chunkIds[c]];
+            r.Bytes(base, rows * sizeof(EntityHandle));
+            for (int k = 0; k < COMP_COUNT; k++) {
+                if (arch.offset[k] >= 0) r.Bytes(base + arch.offset[k], rows * COMPONENT_SIZE[k]);
+            }
+        }
+    }
+    freeChunkCount = r.Get<int>();
+    r.Bytes(freeChunks, freeChunkCount * sizeof(int));
+}
+
+void World::Fail(const char* what) {
+    fprintf(stderr, "World: %s\n", what);
+    abort();
+}
+
+int World::FindArchetype(Signature sig) {
+    for (int a = 0; a < archetypeCount; a++) {
+        if (archetypes[a].signature == sig) return a;
+    }
+    if (archetypeCount == MAX_ARCHETYPES) Fail("too many archetypes");
+
+    Archetype& arch = archetypes[archetypeCount];
+    arch.signature = sig;
+    arch.chunkCount = 0;
+    int rowBytes = sizeof(EntityHandle);
+    for (int c = 0; c < COMP_COUNT; c++) {
+        if (sig & (1u << c)) rowBytes += COMPONENT_SIZE[c];
+    }
+    arch.capacity = (CHUNK_BYTES - 8 * (COMP_COUNT + 1)) / rowBytes;
+    int offset = AlignUp(arch.capacity * (int)sizeof(EntityHandle));
+    for (int c = 0; c < COMP_COUNT; c++) {
+        arch.offset[c] = -1;
+        if (!(sig & (1u << c))) continue;
+        arch.offset[c] = offset;
+        offset = AlignUp(offset + arch.capacity * COMPONENT_SIZE[c]);
+    }
+    return archetypeCount++;
+}
+
+EntityRecord World::AppendRow(int a, EntityHandle h) {
+    Archetype& arch = archetypes[a];
+    if (arch.chunkCount == 0 || arch.chunkRows[arch.chunkCount - 1] == arch.capacity) {
+        if (freeChunkCount == 0 || arch.chunkCount == MAX_CHUNKS) Fail("out of chunks");
+        arch.chunkIds[arch.chunkCount] = freeChunks[--freeChunkCount];
+        arch.chunkRows[arch.chunkCount] = 0;
+        arch.chunkCount++;
+    }
+    EntityRecord rec = { (uint8_t)a, (uint8_t)(arch.chunkCount - 1), (uint16_t)arch.chunkRows[arch.chunkCount - 1]++ };
+    HandleAt(arch, rec.chunk, rec.row) = h;
+    for (int c = 0; c < COMP_COUNT; c++) {
+        if (arch.offset[c] >= 0) memset(Cell(rec, c), 0, COMPONENT_SIZE[c]);
+    }
+    return rec;
+}
+
+void World::RemoveRow(const EntityRecord& rec) {
+    Archetype& arch = archetypes[rec.archetype];
+    int lastChunk = arch.chunkCount - 1;
+    EntityRecord last = { rec.archetype, (uint8_t)lastChunk, (uint16_t)(arch.chunkRows[lastChunk] - 1) };
+    if (last.chunk != rec.chunk || last.row != rec.row) {
+        EntityHandle moved = HandleAt(arch, last.chunk, last.row);
+        HandleAt(arch, rec.chunk, rec.row) = moved;
+        for (int c = 0; c < COMP_COUNT; c++) {
+            if (arch.offset[c] >= 0) memcpy(Cell(rec, c), Cell(last, c), COMPONENT_SIZE[c]);
+        }
+        *directory.Get(moved) = rec;
+    }
+    if (--arch.chunkRows[lastChunk] == 0) {
+        freeChunks[freeChunkCount++] = arch.chunkIds[lastChunk];
+        arch.chunkCount--;
+    }
+}
+
+void World::Move(EntityHandle h, EntityRecord& rec, Signature sig) {
+    EntityRecord from = rec;
+    EntityRecord to = AppendRow(FindArchetype(sig), h);
+    for (int c = 0; c < COMP_COUNT; c++) {
+        if (archetypes[from.archetype].offset[c] >= 0 && archetypes[to.archetype].offset[c] >= 0) {
+            memcpy(Cell(to, c), Cell(from, c), COMPONENT_SIZE[c]);
+        }
+    }
+    RemoveRow(from);
+    rec = to;
+}
+
+void World::RemoveComponent(EntityHandle h, int component) {
+    EntityRecord* rec = directory.Get(h);
+    if (!rec || archetypes[rec->archetype].offset[component] < 0) return;
+    Move(h, *rec, archetypes[rec->archetype].signature & ~(1u << component));
+}
+
+void World::Queue(EntityHandle h, int component) {
+    if (pendingCount == MAX_ENTITIES * 2) Fail("too many deferred changes");
+    pending[pendingCount++] = { h, component };
+}
@@ -0,0 +1,201 @@
+// Archetype entity component system: components, the world that stores them in
+// chunks, and the deferred structural changes systems queue while iterating.
+#pragma once
+
+#include "level_memory.h"
+
+//  Entity Component System 
+// Entities with the same set of components share an archetype. Each archetype keeps
+// its entities in fixed-size chunks laid out column by column (all positions, then
+// all timers, ...), so a system touches only the columns it asks for, front to back.
+enum ComponentId {
+    COMP_POSITION, COMP_MOVE_TIMER, COMP_SPEED, COMP_STAMINA,
+    COMP_INVISIBILITY, COMP_FREEZE, COMP_PICKUP, COMP_CONTROLLED, COMP_GUARD, COMP_MOVE_INTENT,
+    COMP_ANIM_PHASE, COMP_COUNT
+};
+typedef uint32_t Signature; // One bit per ComponentId
+
+enum PickupKind { PICKUP_DIAMOND, PICKUP_NUGGET };
+
+struct Position     { enum { ID = COMP_POSITION };     int x, y; };
+struct MoveTimer    { enum { ID = COMP_MOVE_TIMER };   float elapsed; };
+struct Speed        { enum { ID = COMP_SPEED };        float delay; };  // Seconds per step
+struct Stamina      { enum { ID = COMP_STAMINA };      float value; };  // 0-100
+struct Invisibility { enum { ID = COMP_INVISIBILITY }; float timer; };  // Removed when it runs out
+struct Freeze       { enum { ID = COMP_FREEZE };       float timer; };  // Removed when it runs out
+struct Pickup       { enum { ID = COMP_PICKUP };       PickupKind kind; };
+struct Controlled   { enum { ID = COMP_CONTROLLED };   uint8_t player; }; // Moved by that player's PlayerInput
+enum GuardMode : uint8_t { GUARD_PATROL, GUARD_CHASE, GUARD_SEARCH, GUARD_INVESTIGATE };
+struct Guard        { enum { ID = COMP_GUARD };        uint8_t route; GuardMode mode; uint16_t step; // Patrols, hunts the player
+                      float searchTimer; int16_t lastSeenX, lastSeenY;
+                      float heard;      // Noise already followed up, fading as noise does
+                      uint32_t wander; }; // Own dice for wandering, apart from the rules' rng
+struct MoveIntent   { enum { ID = COMP_MOVE_INTENT };  int dir; double since; }; // Buffered press, DIR_NONE once used
+struct AnimPhase    { enum { ID = COMP_ANIM_PHASE };   float degrees, sin, cos; }; // Offset on the shared animation curves
+
+const int COMPONENT_SIZE[COMP_COUNT] = {
+    sizeof(Position), sizeof(MoveTimer), sizeof(Speed), sizeof(Stamina),
+    sizeof(Invisibility), sizeof(Freeze), sizeof(Pickup), sizeof(Controlled), sizeof(Guard),
+    sizeof(MoveIntent), sizeof(AnimPhase)
+};
+
+template <typename... Ts>
+Signature SignatureOf() { return (0u | ... | (1u << Ts::ID)); }
+
+const int MAX_ENTITIES = 64;
+const int MAX_ARCHETYPES = 16;
+const int MAX_CHUNKS = 16;
+const int CHUNK_BYTES = 4096;
+
+// Where an entity's row lives: archetype, chunk within it, row within the chunk
+struct EntityRecord {
+    uint8_t archetype;
+    uint8_t chunk;
+    uint16_t row;
+};
+
+struct Archetype {
+    Signature signature;
+    int capacity;             // Rows per chunk
+    int offset[COMP_COUNT];   // Byte offset of each column inside a chunk, -1 if absent
+    int chunkIds[MAX_CHUNKS]; // Into World::chunkData; only the last chunk is partly filled
+    int chunkRows[MAX_CHUNKS];
+    int chunkCount;
+};
+
+// All entities of one level. Storage is fixed-size and owned inline, so nothing here
+// allocates; the level that holds the world is recycled as a whole.
+class World {
+public:
+    World() { Clear(); }
+
+    void Clear();
+
+    // New entity with the given components
+    template <typename... Ts>
+    EntityHandle Spawn(const Ts&... components) {
+        EntityHandle h = directory.Add({});
+        if (h.index == NO_ENTITY.index) Fail("too many entities");
+        EntityRecord& rec = *directory.Get(h);
+        rec = AppendRow(FindArchetype(SignatureOf<Ts...>()), h);
+        (Write(rec, components), ...);
+        return h;
+    }
+
+    void Destroy(EntityHandle h);
+
+    bool Alive(EntityHandle h) { return directory.Get(h) != nullptr; }
+
+    // Component of an entity, or nullptr if it has none (or is gone)
+    template <typename T>
+    T* Get(EntityHandle h) {
+        EntityRecord* rec = directory.Get(h);
+        if (!rec || archetypes[rec->archetype].offset[T::ID] < 0) return nullptr;
+        return Column<T>(*rec) + rec->row;
+    }
+
+    template <typename T>
+    bool Has(EntityHandle h) { return Get<T>(h) != nullptr; }
+
+    // Adds the component (moving the entity to another archetype) or overwrites it
+    template <typename T>
+    void Set(EntityHandle h, const T& value) {
+        EntityRecord* rec = directory.Get(h);
+        if (!rec) return;
+        if (archetypes[rec->archetype].offset[T::ID] < 0) Move(h, *rec, archetypes[rec->archetype].signature | (1u << T::ID));
+        Write(*rec, value);
+    }
+
+    template <typename T>
+    void Remove(EntityHandle h) { RemoveComponent(h, T::ID); }
+
+    // Structural changes made while a system iterates are queued and applied by Flush
+    void DeferDestroy(EntityHandle h) { Queue(h, -1); }
+
+    template <typename T>
+    void DeferRemove(EntityHandle h) { Queue(h, T::ID); }
+
+    // True once DeferDestroy was called for h and Flush has not run yet
+    bool DestroyQueued(EntityHandle h) const;
+
+    void Flush();
+
+    // Calls fn(count, handles, columns...) once per chunk holding all of Ts and none of exclude
+    template <typename... Ts, typename Fn>
+    void Each(Fn fn, Signature exclude = 0) {
+        Signature need = SignatureOf<Ts...>();
+        for (int a = 0; a < archetypeCount; a++) {
+            const Archetype& arch = archetypes[a];
+            if ((arch.signature & need) != need || (arch.signature & exclude)) continue;
+            for (int c = 0; c < arch.chunkCount; c++) {
+                unsigned char* base = chunkData[arch.chunkIds[c]];
+                fn(arch.chunkRows[c], (const EntityHandle*)base, (Ts*)(base + arch.offset[Ts::ID])...);
+            }
+        }
+    }
+
+    template <typename... Ts>
+    int Count(Signature exclude = 0) {
+        int n = 0;
+        Each<Ts...>([&](int rows, const EntityHandle*, Ts*...) { n += rows; }, exclude);
+        return n;
+    }
+
+    int EntityCount() const { return directory.Count(); }
+
+    // Only the rows in use are written. Archetypes are recreated in the same order on
+    // load, so column offsets, chunk ids and entity records all come back unchanged.
+    void Save(ByteWriter& w) const;
+    void Load(ByteReader& r);
+
+private:
+    struct Pending {
+        EntityHandle entity;
+        int component; // -1 destroys the entity
+    };
+
+    [[noreturn]] static void Fail(const char* what);
+
+    static int AlignUp(int v) { return (v + 7) & ~7; }
+
+    int FindArchetype(Signature sig);
+
+    template <typename T>
+    T* Column(const EntityRecord& rec) {
+        const Archetype& arch = archetypes[rec.archetype];
+        return (T*)(chunkData[arch.chunkIds[rec.chunk]] + arch.offset[T::ID]);
+    }
+
+    template <typename T>
+    void Write(const EntityRecord& rec, const T& value) { Column<T>(rec)[rec.row] = value; }
+
+    unsigned char* Cell(const EntityRecord& rec, int component) {
+        const Archetype& arch = archetypes[rec.archetype];
+        return chunkData[arch.chunkIds[rec.chunk]] + arch.offset[component] + rec.row * COMPONENT_SIZE[component];
+    }
+
+    EntityHandle& HandleAt(const Archetype& arch, int chunk, int row) {
+        return ((EntityHandle*)chunkData[arch.chunkIds[chunk]])[row];
+    }
+
+    // New zeroed row at the end of the archetype
+    EntityRecord AppendRow(int a, EntityHandle h);
+
+    // Fills the hole with the archetype's last row so chunks stay packed
+    void RemoveRow(const EntityRecord& rec);
+
+    // Re-homes an entity under a new signature, keeping the components both sides share
+    void Move(EntityHandle h, EntityRecord& rec, Signature sig);
+
+    void RemoveComponent(EntityHandle h, int component);
+    void Queue(EntityHandle h, int component);
+
+    Pool<EntityRecord, MAX_ENTITIES> directory;
+    Archetype archetypes[MAX_ARCHETYPES];
+    int archetypeCount = 0;
+    alignas(8) unsigned char chunkData[MAX_CHUNKS][CHUNK_BYTES];
+    int freeChunks[MAX_CHUNKS];
+    int freeChunkCount = 0;
+    Pending pending[MAX_ENTITIES * 2];
+    int pendingCount = 0;
+};
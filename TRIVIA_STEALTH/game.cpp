@@ -0,0 +1,639 @@
+#include "game.h"
+#if defined(__unix__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+//  Global Data 
+Camera2D gameCamera = { {0, 0}, {0, 0}, 0.0f, 1.0f };
+GameState currentState;
+int currentQuestionId = 0;
+int quizPlayer = 0;
+int localPlayer = 0;
+
+//  Noise 
+NoiseField noise;
+
+//  Doors 
+bool ToggleDoor(Level& lvl, int tile, bool force) {
+    unsigned char& cell = lvl.grid.cells[tile];
+    if (cell == TILE_DOOR_OPEN && !force) {
+        int x = tile % lvl.grid.cols;
+        int y = tile / lvl.grid.cols;
+        bool occupied = false;
+        lvl.world.Each<Position>([&](int n, const EntityHandle*, Position* pos) {
+            for (int i = 0; i < n; i++) occupied |= (pos[i].x == x && pos[i].y == y);
+        });
+        if (occupied) return false;
+    }
+    cell = (cell == TILE_DOOR) ? TILE_DOOR_OPEN : TILE_DOOR;
+    lvl.doorVersion++;
+    for (auto& field : lvl.routeFields) field.Changed(lvl.grid, tile, lvl.fieldQueue);
+    if (&lvl == level) noise.MarkStale();
+    return true;
+}
+
+//  Snapshots 
+void SaveGameState(ByteWriter& w) {
+    w.Put(currentState);
+    w.Put(currentQuestionId);
+    w.Put(quizPlayer);
+    w.Put(rng.state);
+    w.Put((int)questionIndices.size());
+    w.Bytes(questionIndices.data(), questionIndices.size() * sizeof(int));
+    if (!level) return; // Menu before the first run
+    w.Put(level->diamondsLeft);
+    uint64_t open = 0;
+    for (size_t i = 0; i < level->doors.size(); i++) {
+        if (level->grid.cells[level->doors[i]] == TILE_DOOR_OPEN) open |= 1ull << i;
+    }
+    w.Put(open);
+    level->world.Save(w);
+    noise.Save(w);
+}
+
+void LoadGameState(ByteReader& r) {
+    currentState = r.Get<GameState>();
+    currentQuestionId = r.Get<int>();
+    quizPlayer = r.Get<int>();
+    rng.state = r.Get<uint32_t>();
+    int questions = r.Get<int>();
+    questionIndices.resize(questions); // Capacity is already there from the first shuffle
+    r.Bytes(questionIndices.data(), questions * sizeof(int));
+    if (!level) return;
+    level->diamondsLeft = r.Get<int>();
+    uint64_t open = r.Get<uint64_t>();
+    for (size_t i = 0; i < level->doors.size(); i++) {
+        int tile = level->doors[i];
+        if ((level->grid.cells[tile] == TILE_DOOR_OPEN) != ((open >> i) & 1)) ToggleDoor(*level, tile, true);
+    }
+    level->world.Load(r);
+    noise.Load(r);
+}
+
+SnapshotRing history;
+long long simTick = 0;
+
+LevelHandoff levelHandoff;
+
+bool resetPending = false;
+
+// A fresh level comes with a fresh player entity, so there is nothing else to reset.
+// The level was pre-built in the background and installing it is a pointer swap;
+// if the build is still running the menu stays up and the next tick tries again.
+void ResetGame() {
+    Level* next = levelPipeline.Take();
+    resetPending = !next;
+    if (!next) return;
+    currentState = PLAYING;
+
+    // Reshuffle (and rig) questions for the new run
+    ShuffleQuestions();
+    history.Clear();
+    simTick = 0;
+
+    levelHandoff.Replace(level);
+    level = next;
+    noise.Reset();
+
+    // Start on the one after this while the current level is played
+    levelPipeline.Request(NextLevelRecipe());
+}
+
+void ResetGameNow() {
+    levelPipeline.WaitUntilBuilt();
+    ResetGame();
+}
+
+//  Quality Governor 
+RenderGovernor governor;
+
+// . Logic .
+
+bool IsValidMove(int x, int y) {
+    if (x < 0 || x >= level->grid.cols || y < 0 || y >= level->grid.rows) return false;
+    return IsOpenTile(level->grid[y][x]);
+}
+
+//  Input Buffer 
+InputBuffer inputBuffer;
+
+//  Input Latency 
+LatencyStats inputLatency;
+bool reportLatency = false;
+
+//  Effects 
+EffectQueue effects;
+
+//  Systems 
+// The rules as passes over the level's world. Player systems skip anything frozen;
+// structural changes (expired effects, collected pickups) are queued and applied
+// before the guards move, so every system sees a stable layout while it iterates.
+
+// A frozen player does nothing else until the timer runs out
+void FreezeSystem(World& world, float dt) {
+    world.Each<Freeze>([&](int n, const EntityHandle* ids, Freeze* freeze) {
+        for (int i = 0; i < n; i++) {
+            freeze[i].timer -= dt;
+            if (freeze[i].timer <= 0) {
+                world.DeferRemove<Freeze>(ids[i]);
+                currentState = PLAYING;
+            }
+        }
+    });
+}
+
+void InvisibilitySystem(World& world, float dt) {
+    world.Each<Invisibility>([&](int n, const EntityHandle* ids, Invisibility* ghost) {
+        for (int i = 0; i < n; i++) {
+            ghost[i].timer -= dt;
+            if (ghost[i].timer <= 0) world.DeferRemove<Invisibility>(ids[i]);
+        }
+    }, SignatureOf<Freeze>());
+}
+
+void PlayerMoveSystem(World& world, const PlayerInput* inputs, float dt) {
+    world.Each<Position, MoveTimer, Stamina, MoveIntent, Controlled>([&](int n, const EntityHandle*, Position* pos, MoveTimer* timer,
+                                                                        Stamina* stamina, MoveIntent* intent, Controlled* controlled) {
+        for (int i = 0; i < n; i++) {
+            const PlayerInput& input = inputs[controlled[i].player];
+
+            // The newest press is kept until the next move slot, even if the key is already up again
+            if (input.pressedDir != DIR_NONE) intent[i] = { input.pressedDir, input.pressedAt };
+
+            // Stamina Regen
+            if (!input.sprint && stamina[i].value < 100.0f) {
+                stamina[i].value += 40.0f * dt;
+            }
+
+            // Smoother Movement Settings
+            Cadence cadence = CADENCE_WALK;
+            if (input.sprint && stamina[i].value > 0) {
+                cadence = CADENCE_SPRINT; // speed of the player
+                stamina[i].value -= 60.0f * dt;
+            }
+            float moveDelay = CADENCE_DELAY[cadence];
+
+            timer[i].elapsed += dt;
+
+            if (timer[i].elapsed >= moveDelay) {
+                int dx = 0;
+                int dy = 0;
+
+                if (input.up) dy = -1;
+                if (input.down) dy = 1;
+                if (input.left) dx = -1;
+                if (input.right) dx = 1;
+
+                int dir = intent[i].dir;
+                if (dir != DIR_NONE || dx != 0 || dy != 0) {
+                    timer[i].elapsed = 0;
+                    bool moved = false;
+
+                    // A buffered press goes first, then the held keys as before
+                    if (dir != DIR_NONE && IsValidMove(pos[i].x + DIR_DX[dir], pos[i].y + DIR_DY[dir])) {
+                        pos[i].x += DIR_DX[dir];
+                        pos[i].y += DIR_DY[dir];
+                        moved = true;
+                        inputLatency.Record(cadence, input.time - intent[i].since);
+                    }
+                    intent[i].dir = DIR_NONE;
+
+                    if (!moved && dy != 0) {
+                        if (IsValidMove(pos[i].x, pos[i].y + dy)) {
+                            pos[i].y += dy;
+                            moved = true;
+                        }
+                    }
+
+                    if (!moved && dx != 0) {
+                        if (IsValidMove(pos[i].x + dx, pos[i].y)) {
+                            pos[i].x += dx;
+                            moved = true;
+                        }
+                    }
+
+                    if (moved && cadence == CADENCE_SPRINT) noise.Emit(pos[i].x, pos[i].y);
+                }
+            }
+
+            if (stamina[i].value < 0) stamina[i].value = 0;
+            if (stamina[i].value > 100) stamina[i].value = 100;
+        }
+    }, SignatureOf<Freeze>());
+}
+
+void PickupSystem(World& world) {
+    world.Each<Position, Controlled>([&](int n, const EntityHandle*, Position* player, Controlled* controlled) {
+        for (int p = 0; p < n; p++) {
+            if (level->grid[player[p].y][player[p].x] == TILE_EXIT) {
+                if (level->diamondsLeft == 0) currentState = VICTORY;
+            }
+
+            world.Each<Position, Pickup>([&](int count, const EntityHandle* ids, Position* pos, Pickup* pickup) {
+                for (int i = 0; i < count; i++) {
+                    if (pos[i].x != player[p].x || pos[i].y != player[p].y) continue;
+                    if (world.DestroyQueued(ids[i])) continue; // The other thief took it this tick
+
+                    effects.Push(pickup[i].kind == PICKUP_DIAMOND ? FX_DIAMOND : FX_NUGGET, pos[i].x, pos[i].y);
+                    if (pickup[i].kind == PICKUP_DIAMOND) {
+                        if (level->diamondsLeft > 0) level->diamondsLeft--;
+                    } else {
+                        // . RANDOM LOGIC .
+                        // If we ran out of unique questions, reshuffle
+                        if (questionIndices.empty()) ShuffleQuestions();
+
+                        // Get the next unique index
+                        int idx = questionIndices.back();
+                        questionIndices.pop_back();
+
+                        currentQuestionId = idx;
+                        quizPlayer = controlled[p].player;
+                        // ........
+
+                        currentState = QUIZ;
+                    }
+                    world.DeferDestroy(ids[i]);
+                }
+            });
+        }
+    }, SignatureOf<Freeze>());
+}
+
+// Thieves open and close the doors next to them
+void DoorSystem(World& world, const PlayerInput* inputs) {
+    const TileGrid& grid = level->grid;
+    world.Each<Position, Controlled>([&](int n, const EntityHandle*, Position* pos, Controlled* controlled) {
+        for (int i = 0; i < n; i++) {
+            if (!inputs[controlled[i].player].use) continue;
+            for (int d = 0; d < 4; d++) {
+                int x = pos[i].x + DIR_DX[d];
+                int y = pos[i].y + DIR_DY[d];
+                if (x < 0 || x >= grid.cols || y < 0 || y >= grid.rows) continue;
+                if (IsDoorTile(grid[y][x])) ToggleDoor(*level, y * grid.cols + x, false);
+            }
+        }
+    }, SignatureOf<Freeze>());
+}
+
+// Greedy step to the open neighbour closest (as the crow flies) to any of the goals.
+// Always moves if it can, even away from them.
+void ChaseStep(Position& pos, const Position* goals, int goalCount) {
+    Position bestMove = pos;
+    int minDist = 9999;
+    for (int d = 0; d < 4; d++) {
+        int nx = pos.x + DIR_DX[d];
+        int ny = pos.y + DIR_DY[d];
+        if (!IsValidMove(nx, ny)) continue;
+        int dist = 9999;
+        for (int t = 0; t < goalCount; t++) dist = min(dist, abs(nx - goals[t].x) + abs(ny - goals[t].y));
+        if (dist < minDist) {
+            minDist = dist;
+            bestMove = {nx, ny};
+        }
+    }
+    pos = bestMove;
+}
+
+// Random open neighbour, rolled on the guard's own dice
+void WanderStep(Position& pos, Guard& guard) {
+    int open[4];
+    int count = 0;
+    for (int d = 0; d < 4; d++) {
+        if (IsValidMove(pos.x + DIR_DX[d], pos.y + DIR_DY[d])) open[count++] = d;
+    }
+    if (count == 0) return;
+    MazeRng dice(guard.wander);
+    int d = open[dice.Next() % count];
+    guard.wander = dice.state;
+    pos = {pos.x + DIR_DX[d], pos.y + DIR_DY[d]};
+}
+
+// Towards the loudest open neighbour; false once nothing nearby is louder than here
+bool InvestigateStep(Position& pos) {
+    float loudest = noise.Sample(pos.x, pos.y);
+    int best = DIR_NONE;
+    for (int d = 0; d < 4; d++) {
+        int nx = pos.x + DIR_DX[d];
+        int ny = pos.y + DIR_DY[d];
+        if (!IsValidMove(nx, ny)) continue;
+        float heard = noise.Sample(nx, ny);
+        if (heard > loudest) {
+            loudest = heard;
+            best = d;
+        }
+    }
+    if (best == DIR_NONE) return false;
+    pos.x += DIR_DX[best];
+    pos.y += DIR_DY[best];
+    return true;
+}
+
+// Next tile of the guard's loop, or one step back towards it. A guard shut off from
+// its loop by closed doors wanders until one opens.
+void PatrolStep(Position& pos, Guard& guard) {
+    const PatrolRoute& route = level->routes[guard.route];
+    const int* tiles = level->routeTiles.data + route.first;
+    int tile = pos.y * level->grid.cols + pos.x;
+    if (tiles[guard.step] != tile) {
+        unsigned char entry = level->routeSteps[(size_t)guard.route * level->grid.cells.size() + tile];
+        if (entry == ROUTE_OFF) {
+            int dir = level->routeFields[guard.route].StepFrom(level->grid, tile);
+            if (dir == DIR_NONE) {
+                WanderStep(pos, guard);
+                return;
+            }
+            pos.x += DIR_DX[dir];
+            pos.y += DIR_DY[dir];
+            return;
+        }
+        guard.step = entry; // Back on the loop
+    }
+    guard.step = (uint16_t)((guard.step + 1) % route.length);
+    int next = tiles[guard.step];
+    pos = { next % level->grid.cols, next / level->grid.cols };
+}
+
+void GuardSystem(World& world, float dt) {
+    if (world.Count<Controlled>() == 0) return;
+
+    // Guards chase the nearest thief they can see. When everyone turns invisible they
+    // search where they last saw one, then go back to their patrol. A patrolling guard
+    // that hears a noise follows it to where it came from and searches there. Only a
+    // noise louder than the one it last followed up sends it out again, so the fading
+    // remains of that noise do not pull it back.
+    Position targets[MAX_PLAYERS];
+    int targetCount = 0;
+    world.Each<Position, Controlled>([&](int n, const EntityHandle*, Position* pos, Controlled*) {
+        for (int i = 0; i < n; i++) targets[targetCount++] = pos[i];
+    }, SignatureOf<Invisibility>());
+
+    world.Each<Position, MoveTimer, Speed, Guard>([&](int n, const EntityHandle*, Position* pos, MoveTimer* timer, Speed* speed, Guard* guard) {
+        for (int e = 0; e < n; e++) {
+            Guard& g = guard[e];
+            if (targetCount > 0) {
+                g.mode = GUARD_CHASE;
+            } else if (g.mode == GUARD_CHASE) {
+                g.mode = GUARD_SEARCH;
+                g.searchTimer = SEARCH_TIME;
+            } else if (g.mode == GUARD_SEARCH) {
+                if ((g.searchTimer -= dt) <= 0) g.mode = GUARD_PATROL;
+            } else if (g.mode == GUARD_PATROL && noise.Sample(pos[e].x, pos[e].y) > g.heard) {
+                g.mode = GUARD_INVESTIGATE;
+            }
+            g.heard = max(0.0f, g.heard - NOISE_DECAY * dt);
+
+            timer[e].elapsed += dt;
+            float currentSpeed = (currentState == FROZEN) ? speed[e].delay * 0.5f : speed[e].delay;
+
+            if (timer[e].elapsed >= currentSpeed) {
+                timer[e].elapsed = 0;
+
+                if (g.mode == GUARD_CHASE) {
+                    // Remember the closest thief in case it vanishes
+                    int nearest = 0;
+                    for (int t = 1; t < targetCount; t++) {
+                        if (abs(pos[e].x - targets[t].x) + abs(pos[e].y - targets[t].y) <
+                            abs(pos[e].x - targets[nearest].x) + abs(pos[e].y - targets[nearest].y)) nearest = t;
+                    }
+                    g.lastSeenX = (int16_t)targets[nearest].x;
+                    g.lastSeenY = (int16_t)targets[nearest].y;
+                    ChaseStep(pos[e], targets, targetCount);
+                } else if (g.mode == GUARD_INVESTIGATE) {
+                    if (!InvestigateStep(pos[e])) {
+                        g.mode = GUARD_SEARCH;
+                        g.searchTimer = SEARCH_TIME;
+                        g.heard = noise.Sample(pos[e].x, pos[e].y);
+                        g.lastSeenX = (int16_t)pos[e].x;
+                        g.lastSeenY = (int16_t)pos[e].y;
+                    }
+                } else if (g.mode == GUARD_SEARCH) {
+                    Position lastSeen = { g.lastSeenX, g.lastSeenY };
+                    if (pos[e].x != lastSeen.x || pos[e].y != lastSeen.y) ChaseStep(pos[e], &lastSeen, 1);
+                    else WanderStep(pos[e], g);
+                } else {
+                    PatrolStep(pos[e], g);
+                }
+            }
+
+            for (int t = 0; t < targetCount; t++) {
+                if (pos[e].x == targets[t].x && pos[e].y == targets[t].y) currentState = GAME_OVER;
+            }
+        }
+    });
+}
+
+// One tick of play (PLAYING and FROZEN)
+void RunPlaySystems(const PlayerInput* inputs, float dt) {
+    World& world = level->world;
+    noise.Advance(dt);
+    FreezeSystem(world, dt);
+    InvisibilitySystem(world, dt);
+    PlayerMoveSystem(world, inputs, dt);
+    DoorSystem(world, inputs);
+    PickupSystem(world);
+    world.Flush();
+    GuardSystem(world, dt);
+}
+
+void UpdateGame(const PlayerInput* inputs, float dt) {
+    // Menu keys work for either player
+    PlayerInput any = inputs[0];
+    for (int p = 1; p < playerCount; p++) {
+        any.confirm = any.confirm || inputs[p].confirm;
+        any.help = any.help || inputs[p].help;
+        any.back = any.back || inputs[p].back;
+    }
+
+    switch (currentState) {
+        case MENU:
+            if (any.confirm || resetPending) ResetGame();
+            else if (any.help) currentState = HELP;
+            break;
+
+        case HELP:
+            if (any.help || any.confirm || any.back) {
+                currentState = MENU;
+            }
+            break;
+
+        case PLAYING:
+            RunPlaySystems(inputs, dt);
+            break;
+
+        case FROZEN:
+            RunPlaySystems(inputs, dt);
+            break;
+
+        case QUIZ: {
+            // Only the thief who found the nugget answers
+            int choice = inputs[quizPlayer].quizChoice;
+            EntityHandle thief = level->players[quizPlayer];
+            if (choice != -1) {
+                // Copied: Set() can move the thief to another chunk
+                Position at = *level->world.Get<Position>(thief);
+                if (choice == questionBank[currentQuestionId].correctIndex) {
+                    level->world.Set(thief, Invisibility{5.0f});
+                    level->world.Set(thief, Stamina{100.0f});
+                    currentState = PLAYING;
+                    effects.Push(FX_GHOST, at.x, at.y);
+                } else {
+                    level->world.Set(thief, Freeze{3.0f});
+                    currentState = FROZEN;
+                    effects.Push(FX_FREEZE, at.x, at.y);
+                }
+            }
+            break;
+        }
+
+        case GAME_OVER:
+        case VICTORY:
+            if (any.confirm) currentState = MENU;
+            break;
+    }
+}
+
+void UpdateGame(const PlayerInput& input, float dt) {
+    PlayerInput inputs[MAX_PLAYERS] = { input };
+    UpdateGame(inputs, dt);
+}
+
+//  State Stream 
+#if defined(__unix__)
+bool StatePublisher::Open(const char* name) {
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) return false;
+    bool sized = ftruncate(fd, sizeof(StateStream)) == 0;
+    void* memory = sized ? mmap(nullptr, sizeof(StateStream), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (memory == MAP_FAILED) {
+        shm_unlink(name);
+        return false;
+    }
+    this->name = name;
+    stream = (StateStream*)memory;
+    stream->magic = STATE_STREAM_MAGIC;
+    stream->version = STATE_STREAM_VERSION;
+    stream->slotCount = STREAM_SLOTS;
+    stream->recordBytes = sizeof(StateRecord);
+    stream->head.store(0, std::memory_order_relaxed);
+    for (StreamSlot& slot : stream->slots) slot.sequence.store(0, std::memory_order_relaxed);
+    Beat();
+    stream->writerAlive.store(1, std::memory_order_release);
+    return true;
+}
+
+void StatePublisher::Close() {
+    if (!stream) return;
+    stream->writerAlive.store(0, std::memory_order_release);
+    munmap(stream, sizeof(StateStream));
+    shm_unlink(name);
+    stream = nullptr;
+}
+#else
+bool StatePublisher::Open(const char*) { return false; }
+void StatePublisher::Close() {}
+#endif
+
+StatePublisher statePublisher;
+bool publishState = false;
+
+bool OpenStateStream() {
+    if (statePublisher.Open(STATE_STREAM_NAME)) return true;
+    if (errno == EEXIST) {
+        printf("State stream: %s is in use by another game. If none is running, one crashed; remove /dev/shm%s\n",
+               STATE_STREAM_NAME, STATE_STREAM_NAME);
+    } else {
+        printf("State stream: could not create %s\n", STATE_STREAM_NAME);
+    }
+    return false;
+}
+
+void StepGame(const PlayerInput& input, float dt) {
+    bool inLevel = level && currentState != MENU && currentState != HELP;
+    if (inLevel && input.rewind) {
+        if (history.Restore(simTick - 1)) simTick--;
+    } else {
+        UpdateGame(input, dt);
+        if (level && currentState != MENU && currentState != HELP) history.Capture(++simTick);
+    }
+    if (statePublisher.Active()) statePublisher.Publish();
+}
+
+//  Fog of War 
+// Recursive shadowcasting: each of the eight octants around the thief is scanned
+// row by row outwards, and every wall splits the visible slope range in two, with
+// the part beyond it handled by a recursive call. Each tile is looked at once at
+// most, and only within VIEW_RADIUS. Tiles seen earlier stay dimly drawn.
+const int OCTANT_XX[8] = { 1, 0, 0, -1, -1, 0, 0, 1 };
+const int OCTANT_XY[8] = { 0, 1, -1, 0, 0, -1, 1, 0 };
+const int OCTANT_YX[8] = { 0, 1, 1, 0, 0, -1, -1, 0 };
+const int OCTANT_YY[8] = { 1, 0, 0, 1, -1, 0, 0, -1 };
+
+void LightFogTile(FogOfWar& fog, int tile) {
+    unsigned char& alpha = fog.pixels[2 * (size_t)tile + 1];
+    if (alpha == FOG_VISIBLE) return; // Octants overlap along their edges
+    alpha = FOG_VISIBLE;
+    fog.lit.push_back(tile);
+}
+
+// Rows from `row` outwards, between the slopes start (high) and end (low)
+void ShadowcastOctant(Level& lvl, int cx, int cy, int row, float start, float end, int octant) {
+    if (start < end) return;
+    const TileGrid& grid = lvl.grid;
+    float nextStart = start;
+    for (int j = row; j <= VIEW_RADIUS; j++) {
+        bool blocked = false;
+        for (int dx = -j, dy = -j; dx <= 0; dx++) {
+            float leftSlope = (dx - 0.5f) / (dy + 0.5f);
+            float rightSlope = (dx + 0.5f) / (dy - 0.5f);
+            if (start < rightSlope) continue;
+            if (end > leftSlope) break;
+
+            int x = cx + dx * OCTANT_XX[octant] + dy * OCTANT_XY[octant];
+            int y = cy + dx * OCTANT_YX[octant] + dy * OCTANT_YY[octant];
+            bool inside = x >= 0 && x < grid.cols && y >= 0 && y < grid.rows;
+            if (inside && dx * dx + dy * dy <= VIEW_RADIUS * VIEW_RADIUS) LightFogTile(lvl.fog, y * grid.cols + x);
+
+            bool opaque = !inside || !IsOpenTile(grid[y][x]);
+            if (blocked) {
+                if (opaque) {
+                    nextStart = rightSlope;
+                } else {
+                    blocked = false;
+                    start = nextStart;
+                }
+            } else if (opaque && j < VIEW_RADIUS) {
+                blocked = true;
+                ShadowcastOctant(lvl, cx, cy, j + 1, start, leftSlope, octant);
+                nextStart = rightSlope;
+            }
+        }
+        if (blocked) break;
+    }
+}
+
+// Dims what the last cast lit and lights what is in view from the tile now
+void CastFog(Level& lvl, int cx, int cy) {
+    FogOfWar& fog = lvl.fog;
+    for (int tile : fog.lit) fog.pixels[2 * (size_t)tile + 1] = FOG_REMEMBERED;
+    fog.lit.clear();
+    LightFogTile(fog, cy * lvl.grid.cols + cx);
+    for (int octant = 0; octant < 8; octant++) ShadowcastOctant(lvl, cx, cy, 1, 1.0f, 0.0f, octant);
+}
+
+void UpdateFogOfWar() {
+    FogOfWar& fog = level->fog;
+    const Position* p = level->world.Get<Position>(level->players[localPlayer]);
+    if (!p) return;
+    int tile = p->y * level->grid.cols + p->x;
+    if (tile == fog.castTile && level->doorVersion == fog.castDoors) return;
+    fog.castTile = tile;
+    fog.castDoors = level->doorVersion;
+    CastFog(*level, p->x, p->y);
+}
+
+bool IsTileVisible(int x, int y) {
+    return level->fog.pixels[2 * ((size_t)y * level->grid.cols + x) + 1] == FOG_VISIBLE;
+}
@@ -0,0 +1,801 @@
+// Game rules and the state they act on: noise, doors, snapshots and rewind, the
+// quality governor, input, effects, the systems, the state stream and fog of war.
+#pragma once
+
+#include "level.h"
+#include "thread_handoff.h"
+#include "state_stream.h"
+
+//  Global Data 
+extern Camera2D gameCamera;
+extern GameState currentState;
+extern int currentQuestionId; // Index into questionBank; the quiz never copies the question
+extern int quizPlayer;        // Who picked up the nugget and answers the quiz
+extern int localPlayer;       // The thief this window follows and shows stats for
+
+//  Noise 
+// Sprinting is loud. Each sprint step emits a noise that spreads over the grid,
+// losing one unit per floor tile and more per wall it passes through, and fades
+// over time. Spreading is a Dijkstra over a bucket queue that stops at the
+// loudness, so an emission only touches the tiles it can reach.
+//
+// Fading is lazy: a tile keeps the amplitude and time of its loudest noise and the
+// current value is worked out when it is read, so nothing sweeps the map per tick.
+// The field itself is derived data. Game state only holds the recent emissions, and
+// the field is rebuilt from them after a snapshot is loaded.
+const int NOISE_LOUDNESS = 8;      // Reach of a sprint step over open floor, in tiles
+const int NOISE_WALL_COST = 3;     // Units lost passing through a wall tile or closed door
+const float NOISE_DECAY = 4.0f;    // Units lost per second
+const int MAX_NOISE_EVENTS = 64;   // More than ever live at once (lifetime is loudness / decay)
+
+struct NoiseEvent {
+    int tile;
+    float time;
+};
+
+class NoiseField {
+public:
+    // New level: its cells were zeroed at load, which matches no epoch in use
+    void Reset() {
+        clock = 0;
+        count = 0;
+        epoch++;
+        stale = false;
+    }
+
+    void Advance(float dt) {
+        clock += dt;
+        int expired = 0;
+        while (expired < count && clock - events[expired].time >= NOISE_LOUDNESS / NOISE_DECAY) expired++;
+        if (expired == 0) return;
+        count -= expired;
+        memmove(events, events + expired, count * sizeof(NoiseEvent));
+    }
+
+    void Emit(int x, int y) {
+        if (stale) Rebuild();
+        if (count == MAX_NOISE_EVENTS) {
+            count--;
+            memmove(events, events + 1, count * sizeof(NoiseEvent));
+        }
+        NoiseEvent e = { y * level->grid.cols + x, clock };
+        events[count++] = e;
+        Spread(e);
+        emitted++;
+    }
+
+    // Current loudness at a tile, 0 when silent
+    float Sample(int x, int y) {
+        if (stale) Rebuild();
+        const NoiseCell& cell = level->noise[y * level->grid.cols + x];
+        if (cell.epoch != epoch) return 0.0f;
+        return max(0.0f, cell.amplitude - NOISE_DECAY * (clock - cell.time));
+    }
+
+    void Save(ByteWriter& w) const {
+        w.Put(clock);
+        w.Put(count);
+        w.Bytes(events, count * sizeof(NoiseEvent));
+    }
+
+    void Load(ByteReader& r) {
+        clock = r.Get<float>();
+        count = r.Get<int>();
+        r.Bytes(events, count * sizeof(NoiseEvent));
+        stale = true; // Rebuilt on first use rather than on every restore
+    }
+
+    // A door moved, so the recent noises carry differently now
+    void MarkStale() { stale = true; }
+
+    long long emitted = 0;
+    long long tilesTouched = 0;
+
+private:
+    void Rebuild() {
+        stale = false;
+        epoch++;
+        for (int i = 0; i < count; i++) Spread(events[i]);
+    }
+
+    // Bounded Dijkstra from the event's tile. Costs are small integers, so the
+    // queue is one bucket per remaining unit of loudness.
+    void Spread(const NoiseEvent& e) {
+        const TileGrid& grid = level->grid;
+        ArenaArray<NoiseCell>& cells = level->noise;
+        int cols = grid.cols;
+        int rows = grid.rows;
+        float fade = NOISE_DECAY * (clock - e.time);
+        visit++;
+
+        for (int b = 0; b <= NOISE_LOUDNESS; b++) bucketCount[b] = 0;
+        bucket[0][bucketCount[0]++] = e.tile;
+        cells[e.tile].visit = visit;
+        cells[e.tile].cost = 0;
+
+        for (int cost = 0; cost <= NOISE_LOUDNESS; cost++) {
+            for (int i = 0; i < bucketCount[cost]; i++) {
+                int cur = bucket[cost][i];
+                NoiseCell& cell = cells[cur];
+                if (cell.cost != cost) continue; // Reached more cheaply since it was queued
+                tilesTouched++;
+
+                // Keep whichever noise is louder right now
+                float value = NOISE_LOUDNESS - cost - fade;
+                float current = cell.epoch == epoch ? cell.amplitude - NOISE_DECAY * (clock - cell.time) : 0.0f;
+                if (value > current) {
+                    cell.amplitude = (float)(NOISE_LOUDNESS - cost);
+                    cell.time = e.time;
+                    cell.epoch = epoch;
+                }
+
+                int cx = cur % cols;
+                int cy = cur / cols;
+                int next[4] = { cur - cols, cur + cols, cur - 1, cur + 1 };
+                bool inside[4] = { cy > 0, cy < rows - 1, cx > 0, cx < cols - 1 };
+                for (int d = 0; d < 4; d++) {
+                    if (!inside[d]) continue;
+                    int nb = next[d];
+                    int nextCost = cost + (IsOpenTile(grid.cells[nb]) ? 1 : NOISE_WALL_COST);
+                    if (nextCost > NOISE_LOUDNESS) continue;
+                    NoiseCell& other = cells[nb];
+                    if (other.visit == visit && other.cost <= nextCost) continue;
+                    other.visit = visit;
+                    other.cost = (uint8_t)nextCost;
+                    bucket[nextCost][bucketCount[nextCost]++] = nb;
+                }
+            }
+        }
+    }
+
+    // A tile enters each bucket at most once, and only tiles within the loudness enter at all
+    static const int BUCKET_CAPACITY = (2 * NOISE_LOUDNESS + 1) * (2 * NOISE_LOUDNESS + 1);
+
+    float clock = 0;
+    NoiseEvent events[MAX_NOISE_EVENTS];
+    int count = 0;
+    uint32_t epoch = 1;   // Cells written under another epoch read as silent
+    uint32_t visit = 0;   // Marks cells already queued by the current spread
+    bool stale = false;
+    int bucket[NOISE_LOUDNESS + 1][BUCKET_CAPACITY];
+    int bucketCount[NOISE_LOUDNESS + 1];
+};
+
+extern NoiseField noise;
+
+//  Doors 
+// Opens or closes a door and repairs every guard's way back to its loop around it.
+// Anything standing in a doorway keeps it open, unless forced by a snapshot restore.
+bool ToggleDoor(Level& lvl, int tile, bool force);
+
+//  Snapshots 
+// The whole mutable game state packed into a few hundred bytes. The level itself
+// (grid, walls, nav tables) only changes during play where a door opens or closes,
+// so it is stored by pointer plus one bit per door; the world, the pickup count and
+// the game flow globals are written out in full.
+const size_t SNAPSHOT_MAX_BYTES = 16 * 1024;
+
+void SaveGameState(ByteWriter& w);
+
+void LoadGameState(ByteReader& r);
+
+// Per-tick history for rewind. Every KEYFRAME_INTERVAL-th entry holds the full state,
+// the rest hold the XOR against the previous tick with runs of unchanged bytes
+// skipped. Entries live back to back in one circular byte buffer; the oldest are
+// evicted as it wraps. History only covers the current level and is cleared on reset.
+class SnapshotRing {
+public:
+    void Clear() {
+        head = 0;
+        count = 0;
+        writePos = 0;
+        prevSize = 0;
+    }
+
+    void Capture(long long tick) {
+        ByteWriter w = { scratch, SNAPSHOT_MAX_BYTES };
+        SaveGameState(w);
+
+        bool keyframe = count == 0 || tick % KEYFRAME_INTERVAL == 0;
+        ByteWriter e = { encoded, sizeof(encoded) };
+        if (!keyframe) {
+            EncodeDelta(e, scratch, w.size);
+            keyframe = e.size >= w.size; // Almost everything changed; the full state is smaller
+        }
+        if (keyframe) {
+            e.size = 0;
+            e.Bytes(scratch, w.size);
+        }
+
+        Entry& entry = Append(e.size);
+        entry.tick = tick;
+        entry.keyframe = keyframe;
+        memcpy(storage + entry.offset, encoded, e.size);
+
+        memcpy(prev, scratch, w.size);
+        prevSize = w.size;
+        bytesCaptured += e.size;
+    }
+
+    // Puts the game back to the given tick and forgets everything after it
+    bool Restore(long long tick) {
+        int index = Find(tick);
+        if (index < 0) return false;
+        int first = index;
+        while (!At(first).keyframe) {
+            if (first == 0) return false; // Its keyframe has been evicted
+            first--;
+        }
+
+        const Entry& key = At(first);
+        memcpy(prev, storage + key.offset, key.size);
+        prevSize = key.size;
+        for (int i = first + 1; i <= index; i++) {
+            const Entry& d = At(i);
+            prevSize = DecodeDelta(storage + d.offset, d.size, prev, prevSize);
+        }
+
+        ByteReader r = { prev, prevSize };
+        LoadGameState(r);
+
+        count = index + 1;
+        const Entry& last = At(index);
+        writePos = last.offset + last.size;
+        return true;
+    }
+
+    bool Empty() const { return count == 0; }
+    long long NewestTick() const { return count ? At(count - 1).tick : -1; }
+    long long OldestTick() const { return count ? At(0).tick : -1; }
+    int Count() const { return count; }
+    long long bytesCaptured = 0;
+
+private:
+    static const int KEYFRAME_INTERVAL = 16;
+    static const int MAX_ENTRIES = 4096;
+    static const size_t STORAGE_BYTES = 512 * 1024;
+
+    struct Entry {
+        long long tick;
+        size_t offset;
+        size_t size;
+        bool keyframe;
+    };
+
+    Entry& At(int i) { return entries[(head + i) % MAX_ENTRIES]; }
+    const Entry& At(int i) const { return entries[(head + i) % MAX_ENTRIES]; }
+
+    int Find(long long tick) const {
+        if (count == 0) return -1;
+        long long i = tick - At(0).tick; // One entry per tick, so the index is direct
+        if (i < 0 || i >= count || At((int)i).tick != tick) return -1;
+        return (int)i;
+    }
+
+    // Space for a new entry at the write position, evicting whatever it overlaps
+    Entry& Append(size_t size) {
+        if (writePos + size > STORAGE_BYTES) {
+            // Everything between here and the end is older than what sits at the start
+            while (count > 0 && At(0).offset >= writePos) Evict();
+            writePos = 0;
+        }
+        while (count > 0 && At(0).offset >= writePos && At(0).offset < writePos + size) Evict();
+        if (count == MAX_ENTRIES) Evict();
+
+        Entry& entry = At(count++);
+        entry.offset = writePos;
+        entry.size = size;
+        writePos += size;
+        return entry;
+    }
+
+    void Evict() {
+        head = (head + 1) % MAX_ENTRIES;
+        count--;
+    }
+
+    // [u16 new size] then pairs of [u16 unchanged run][u16 changed run][changed bytes, XORed]
+    void EncodeDelta(ByteWriter& e, const unsigned char* cur, size_t size) {
+        e.Put((uint16_t)size);
+        size_t i = 0;
+        while (i < size) {
+            size_t same = i;
+            while (same < size && cur[same] == (same < prevSize ? prev[same] : 0) && same - i < 0xFFFF) same++;
+            size_t diff = same;
+            while (diff < size && cur[diff] != (diff < prevSize ? prev[diff] : 0) && diff - same < 0xFFFF) diff++;
+            e.Put((uint16_t)(same - i));
+            e.Put((uint16_t)(diff - same));
+            for (size_t k = same; k < diff; k++) e.Put((unsigned char)(cur[k] ^ (k < prevSize ? prev[k] : 0)));
+            i = diff;
+        }
+    }
+
+    static size_t DecodeDelta(const unsigned char* src, size_t n, unsigned char* state, size_t stateSize) {
+        ByteReader r = { src, n };
+        size_t size = r.Get<uint16_t>();
+        if (size > stateSize) memset(state + stateSize, 0, size - stateSize);
+        size_t i = 0;
+        while (r.pos < n) {
+            i += r.Get<uint16_t>();
+            size_t changed = r.Get<uint16_t>();
+            for (size_t k = 0; k < changed; k++, i++) state[i] ^= r.Get<unsigned char>();
+        }
+        return size;
+    }
+
+    Entry entries[MAX_ENTRIES];
+    int head = 0;
+    int count = 0;
+    size_t writePos = 0;
+    unsigned char storage[STORAGE_BYTES];
+    unsigned char scratch[SNAPSHOT_MAX_BYTES];
+    unsigned char encoded[SNAPSHOT_MAX_BYTES * 3]; // Worst-case delta is 2.5x the state
+    unsigned char prev[SNAPSHOT_MAX_BYTES];
+    size_t prevSize = 0;
+};
+
+extern SnapshotRing history;
+extern long long simTick; // Ticks played on the current level; the history is keyed by it
+
+// Replaced levels go back to the pipeline, but while a render thread is running it
+// may still be drawing one: its snapshots name the level by serial, and a level is
+// only retired once the render thread reports a newer serial.
+class LevelHandoff {
+public:
+    uint32_t serial = 0;             // Of the installed level; simulation side
+    std::atomic<uint32_t> drawn{0};  // Newest serial the render thread has switched to
+    bool rendering = false;          // Set while the simulation thread runs; headless retires at once
+
+    void Replace(Level* old) {
+        serial++;
+        if (!old) return;
+        if (!rendering) {
+            levelPipeline.Retire(old);
+            return;
+        }
+        // A few restarts inside one frame at most; wait for the render thread otherwise
+        while (parkedCount == MAX_PARKED) {
+            Collect();
+            if (parkedCount == MAX_PARKED) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        parked[parkedCount++] = { old, serial };
+    }
+
+    void Collect() {
+        uint32_t seen = drawn.load(std::memory_order_acquire);
+        for (int i = parkedCount - 1; i >= 0; i--) {
+            if ((int32_t)(seen - parked[i].replacedBy) < 0) continue;
+            levelPipeline.Retire(parked[i].level);
+            parked[i] = parked[--parkedCount];
+        }
+    }
+
+    // Once nothing draws any more
+    void ReleaseAll() {
+        for (int i = 0; i < parkedCount; i++) levelPipeline.Retire(parked[i].level);
+        parkedCount = 0;
+    }
+
+private:
+    struct Parked {
+        Level* level;
+        uint32_t replacedBy;
+    };
+    static const int MAX_PARKED = 4;
+    Parked parked[MAX_PARKED];
+    int parkedCount = 0;
+};
+
+extern LevelHandoff levelHandoff;
+
+extern bool resetPending; // A run was started before its level was built
+
+// Headless checks script whole runs, so they wait for the build instead
+void ResetGameNow();
+
+//  Quality Governor 
+// Keeps gameplay frames inside the 60 FPS budget on slow GPUs and software GL.
+// The playfield is drawn offscreen at a render scale and stretched to the window,
+// and the quality tier trims cosmetic primitives. raylib has no GPU timer queries,
+// so the GPU side is inferred: a frame over budget while our own CPU work is well
+// under it was spent waiting in the buffer swap. Over budget, the governor lowers
+// the tier when CPU-bound and the scale when GPU-bound. Headroom cannot be seen
+// through the frame limiter, so it probes one step back up after a calm stretch,
+// and waits twice as long before the next probe if that one failed.
+enum QualityTier { QUALITY_LOW, QUALITY_MEDIUM, QUALITY_HIGH, QUALITY_COUNT };
+
+struct QualitySettings {
+    const char* name;
+    int roundSegments;   // Thief bodies; 0 draws plain rectangles
+    bool shadows;
+    bool outlines;       // Diamond and guard outlines
+    bool glow;           // Pulsing halo round nuggets
+    float particleShare; // Of each burst's particle count
+};
+
+const QualitySettings QUALITY_TIERS[QUALITY_COUNT] = {
+    { "low", 0, false, false, false, 0.25f },
+    { "medium", 4, true, false, false, 0.5f },
+    { "high", 6, true, true, true, 1.0f },
+};
+
+const int FULL_FPS = 60;
+const float FRAME_BUDGET_MS = 1000.0f / FULL_FPS;
+const float RENDER_SCALES[] = { 0.5f, 0.6f, 0.7f, 0.85f, 1.0f };
+const int SCALE_STEPS = (int)std::size(RENDER_SCALES);
+const float GOVERNOR_SMOOTHING = 0.1f;  // Weight of the newest frame in the averages
+const double GOVERNOR_SETTLE = 0.5;     // Seconds after a change before judging again
+const double PROBE_WAIT_MIN = 2.0;
+const double PROBE_WAIT_MAX = 32.0;
+
+struct RenderGovernor {
+    int scaleStep = SCALE_STEPS - 1;
+    QualityTier tier = QUALITY_HIGH;
+    bool pinScale = false;  // Set from the command line; the governor leaves it alone
+    bool pinTier = false;
+    float frameMs = FRAME_BUDGET_MS; // Smoothed
+    float cpuMs = 0;
+    double settle = GOVERNOR_SETTLE; // Lets the averages fill before the first decision
+    double calm = 0;          // Seconds in a row with headroom
+    double probeWait = PROBE_WAIT_MIN;
+    double sinceProbe = -1;   // Seconds since the last step up, -1 once it has held
+    int changes = 0;
+
+    float Scale() const { return RENDER_SCALES[scaleStep]; }
+    const QualitySettings& Quality() const { return QUALITY_TIERS[tier]; }
+
+    // Outside gameplay the frame rate is lowered on purpose; start fresh when it returns
+    void Pause() {
+        frameMs = FRAME_BUDGET_MS;
+        cpuMs = 0;
+        calm = 0;
+        settle = GOVERNOR_SETTLE;
+        sinceProbe = -1;
+    }
+
+    void PinScale(float scale) {
+        scaleStep = 0;
+        for (int i = 1; i < SCALE_STEPS; i++) {
+            if (fabsf(RENDER_SCALES[i] - scale) < fabsf(RENDER_SCALES[scaleStep] - scale)) scaleStep = i;
+        }
+        pinScale = true;
+    }
+
+    void PinTier(QualityTier t) {
+        tier = t;
+        pinTier = true;
+    }
+
+    // frame: wall time of the last frame; cpu: the part spent simulating and recording/submitting
+    void Update(float frame, float cpu) {
+        double dt = frame / 1000.0;
+        frameMs += (frame - frameMs) * GOVERNOR_SMOOTHING;
+        cpuMs += (cpu - cpuMs) * GOVERNOR_SMOOTHING;
+        settle -= dt;
+        if (sinceProbe >= 0) {
+            sinceProbe += dt;
+            if (sinceProbe > PROBE_WAIT_MIN) { // The step up held
+                sinceProbe = -1;
+                probeWait = max(PROBE_WAIT_MIN, probeWait / 2);
+            }
+        }
+        if (settle > 0) return;
+
+        if (frameMs > FRAME_BUDGET_MS * 1.03f) {
+            if (sinceProbe >= 0) { // The probe failed
+                probeWait = min(PROBE_WAIT_MAX, probeWait * 2);
+                sinceProbe = -1;
+            }
+            calm = 0;
+            if (Lower(cpuMs > FRAME_BUDGET_MS * 0.75f)) Changed();
+        } else if (frameMs < FRAME_BUDGET_MS * 1.02f && cpuMs < FRAME_BUDGET_MS * 0.5f) {
+            calm += dt;
+            if (calm >= probeWait && Raise()) {
+                calm = 0;
+                sinceProbe = 0;
+                Changed();
+            }
+        } else {
+            calm = 0;
+        }
+    }
+
+private:
+    bool LowerScale() {
+        if (pinScale || scaleStep == 0) return false;
+        scaleStep--;
+        return true;
+    }
+
+    bool LowerTier() {
+        if (pinTier || tier == QUALITY_LOW) return false;
+        tier = (QualityTier)(tier - 1);
+        return true;
+    }
+
+    bool Lower(bool cpuBound) {
+        // Fewer pixels do not help a CPU-bound frame; fewer primitives do
+        if (cpuBound) return LowerTier() || LowerScale();
+        return LowerScale() || LowerTier();
+    }
+
+    // Sharpness first, then the trimmings
+    bool Raise() {
+        if (!pinScale && scaleStep < SCALE_STEPS - 1) {
+            scaleStep++;
+            return true;
+        }
+        if (!pinTier && tier < QUALITY_HIGH) {
+            tier = (QualityTier)(tier + 1);
+            return true;
+        }
+        return false;
+    }
+
+    void Changed() {
+        settle = GOVERNOR_SETTLE;
+        changes++;
+    }
+};
+
+extern RenderGovernor governor;
+
+//  Input Buffer 
+// Key transitions are queued with the time they were seen and folded into one
+// PlayerInput per tick, so no press is lost between ticks and the rules know when
+// it happened. raylib reports key state once per frame, so a transition is stamped
+// with the time of the poll that saw it. The render thread polls and the
+// simulation thread consumes, so the events travel through an SPSC ring.
+struct InputEvent {
+    int key;
+    bool down;
+    double time;
+    bool resync = false; // Only restates whether the key is held; not a press or release
+};
+
+// Keys the game reacts to: polled here, and any press wakes the frame scheduler
+const int WATCHED_KEYS[] = { KEY_UP, KEY_DOWN, KEY_LEFT, KEY_RIGHT, KEY_LEFT_SHIFT, KEY_ENTER, KEY_H,
+                             KEY_ESCAPE, KEY_BACKSPACE, KEY_E, KEY_ONE, KEY_TWO, KEY_THREE, KEY_KP_1, KEY_KP_2, KEY_KP_3 };
+
+// Keys whose held state carries over between ticks
+const int HELD_KEYS[] = { KEY_UP, KEY_DOWN, KEY_LEFT, KEY_RIGHT, KEY_LEFT_SHIFT, KEY_BACKSPACE };
+
+class InputBuffer {
+public:
+    // The ring is full only if nothing was consumed for 64 key changes (a stalled
+    // simulation thread). Presses lost then are gone, but a lost release would leave
+    // a key held, so the next poll restates every held key from the keyboard.
+    void Push(int key, bool down, double time) {
+        if (!events.Push({ key, down, time })) overflowed = true;
+    }
+
+    void Poll(double now) {
+        if (overflowed) {
+            overflowed = false;
+            for (int key : HELD_KEYS) {
+                if (!events.Push({ key, IsKeyDown(key), now, true })) overflowed = true;
+            }
+        }
+        for (int key : WATCHED_KEYS) {
+            if (IsKeyPressed(key)) Push(key, true, now);
+            if (IsKeyReleased(key)) Push(key, false, now);
+        }
+    }
+
+    // Everything since the last call, in order; held keys carry over between calls
+    PlayerInput Consume(double now) {
+        PlayerInput in = {};
+        InputEvent e;
+        while (events.Pop(e)) {
+            int dir = DIR_NONE;
+            switch (e.key) {
+                case KEY_UP: held[DIR_UP] = e.down; dir = DIR_UP; break;
+                case KEY_DOWN: held[DIR_DOWN] = e.down; dir = DIR_DOWN; break;
+                case KEY_LEFT: held[DIR_LEFT] = e.down; dir = DIR_LEFT; break;
+                case KEY_RIGHT: held[DIR_RIGHT] = e.down; dir = DIR_RIGHT; break;
+                case KEY_LEFT_SHIFT: sprintHeld = e.down; break;
+                case KEY_BACKSPACE: rewindHeld = e.down; break;
+            }
+            if (!e.down || e.resync) continue;
+            if (dir != DIR_NONE) {
+                in.pressedDir = dir;
+                in.pressedAt = e.time;
+            }
+            if (e.key == KEY_ENTER) in.confirm = true;
+            if (e.key == KEY_H) in.help = true;
+            if (e.key == KEY_ESCAPE) in.back = true;
+            if (e.key == KEY_E) in.use = true;
+            if (e.key == KEY_ONE || e.key == KEY_KP_1) in.quizChoice = 0;
+            if (e.key == KEY_TWO || e.key == KEY_KP_2) in.quizChoice = 1;
+            if (e.key == KEY_THREE || e.key == KEY_KP_3) in.quizChoice = 2;
+        }
+        in.up = held[DIR_UP];
+        in.down = held[DIR_DOWN];
+        in.left = held[DIR_LEFT];
+        in.right = held[DIR_RIGHT];
+        in.sprint = sprintHeld;
+        in.rewind = rewindHeld;
+        in.time = now;
+        return in;
+    }
+
+private:
+    SpscRing<InputEvent, 64> events;
+    bool overflowed = false; // Producer side
+    bool held[4] = {};  // Consumer side from here on
+    bool sprintHeld = false;
+    bool rewindHeld = false;
+};
+
+extern InputBuffer inputBuffer;
+
+//  Input Latency 
+// Key-down to position-change time for buffered presses, kept per move cadence
+enum Cadence { CADENCE_WALK, CADENCE_SPRINT, CADENCE_COUNT };
+const float CADENCE_DELAY[CADENCE_COUNT] = { 0.12f, 0.06f };
+const char* const CADENCE_NAMES[CADENCE_COUNT] = { "walk", "sprint" };
+
+struct LatencyStats {
+    static const int MAX_SAMPLES = 4096; // Newest samples win once full
+    float samples[CADENCE_COUNT][MAX_SAMPLES];
+    long long recorded[CADENCE_COUNT] = {};
+
+    void Record(Cadence c, double seconds) {
+        samples[c][recorded[c] % MAX_SAMPLES] = (float)seconds;
+        recorded[c]++;
+    }
+
+    int Count(Cadence c) const { return (int)min<long long>(recorded[c], MAX_SAMPLES); }
+
+    // p in [0, 1]; seconds
+    float Percentile(Cadence c, float p) const {
+        int n = Count(c);
+        if (n == 0) return 0.0f;
+        float sorted[MAX_SAMPLES];
+        memcpy(sorted, samples[c], n * sizeof(float));
+        int k = min(n - 1, (int)(p * n));
+        std::nth_element(sorted, sorted + k, sorted + n);
+        return sorted[k];
+    }
+
+    void Print() const {
+        for (int c = 0; c < CADENCE_COUNT; c++) {
+            Cadence cad = (Cadence)c;
+            printf("Input latency %-6s (%.2f s cadence): %lld moves, p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+                   CADENCE_NAMES[c], CADENCE_DELAY[c], recorded[c], Percentile(cad, 0.5f) * 1000.0f,
+                   Percentile(cad, 0.95f) * 1000.0f, Percentile(cad, 0.99f) * 1000.0f, Percentile(cad, 1.0f) * 1000.0f);
+        }
+    }
+};
+
+extern LatencyStats inputLatency;
+extern bool reportLatency;
+
+//  Effects 
+// Moments worth a particle burst. The rules only queue them; the draw side turns them
+// into particles, so effects stay out of the game state, snapshots and co-op hashes.
+// They cross from the simulation thread to the render thread in an SPSC ring rather
+// than in render snapshots, which may be skipped.
+enum EffectKind : uint8_t { FX_DIAMOND, FX_NUGGET, FX_GHOST, FX_FREEZE };
+
+struct EffectEvent {
+    EffectKind kind;
+    int16_t x, y; // Tile
+};
+
+class EffectQueue {
+public:
+    void Push(EffectKind kind, int x, int y) {
+        events.Push({ kind, (int16_t)x, (int16_t)y }); // Nobody drained (headless): the burst is skipped
+    }
+
+    bool Pop(EffectEvent& out) { return events.Pop(out); }
+
+private:
+    SpscRing<EffectEvent, 64> events;
+};
+
+extern EffectQueue effects;
+
+//  Systems 
+// The rules as passes over the level's world. Player systems skip anything frozen;
+// structural changes (expired effects, collected pickups) are queued and applied
+// before the guards move, so every system sees a stable layout while it iterates.
+
+// Exit and pickups under the (unfrozen) player
+void PickupSystem(World& world);
+
+const float SEARCH_TIME = 4.0f; // Seconds a guard looks around where it lost the thief
+
+// One simulation step for the current state, with one input per player seat.
+// Shared by the window loop, co-op lockstep and the headless checks.
+void UpdateGame(const PlayerInput* inputs, float dt);
+
+void UpdateGame(const PlayerInput& input, float dt);
+
+//  State Stream 
+// Optional live feed for outside tools (--publish-state): one fixed-size record per
+// tick into a ring in POSIX shared memory, layout in state_stream.h. The game only
+// ever writes; readers poll at their own pace and can never hold up a tick.
+// A heartbeat goes with it, so readers can tell a game that died from a quiet one.
+class StatePublisher {
+public:
+    // Fails with EEXIST rather than taking over another game's stream. Always fails
+    // without POSIX shared memory.
+    bool Open(const char* name);
+    void Close();
+
+    bool Active() const { return stream != nullptr; }
+
+    // Every tick, published or not (a stalled co-op tick publishes nothing)
+    void Beat() {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch());
+        stream->heartbeatMs.store((uint64_t)ms.count(), std::memory_order_relaxed);
+    }
+
+    void Publish() {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t n = ++published;
+        StreamSlot& slot = stream->slots[n % STREAM_SLOTS];
+        slot.sequence.store(2 * n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        Fill(slot.record, n);
+        slot.sequence.store(2 * n, std::memory_order_release);
+        stream->head.store(n, std::memory_order_release);
+        Beat();
+        publishSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void PrintStats() const {
+        printf("State stream: %llu records, %.2f us each\n", (unsigned long long)published,
+               published ? publishSeconds * 1e6 / published : 0.0);
+    }
+
+private:
+    // Straight into the shared slot, no staging copy
+    static void Fill(StateRecord& r, uint64_t tick) {
+        r.tick = tick;
+        r.state = currentState;
+        r.diamondsLeft = level ? level->diamondsLeft : 0;
+        r.playerCount = 0;
+        r.guardCount = 0;
+        if (!level) return;
+
+        World& world = level->world;
+        for (int p = 0; p < MAX_PLAYERS && p < STREAM_MAX_PLAYERS; p++) {
+            const Position* pos = world.Get<Position>(level->players[p]);
+            if (!pos) continue;
+            const Stamina* stamina = world.Get<Stamina>(level->players[p]);
+            const Invisibility* ghost = world.Get<Invisibility>(level->players[p]);
+            const Freeze* freeze = world.Get<Freeze>(level->players[p]);
+            r.players[r.playerCount++] = { (int16_t)pos->x, (int16_t)pos->y, stamina ? stamina->value : 0.0f,
+                                           ghost ? ghost->timer : 0.0f, freeze ? freeze->timer : 0.0f };
+        }
+        world.Each<Position, Guard>([&](int n, const EntityHandle*, Position* pos, Guard*) {
+            for (int i = 0; i < n && r.guardCount < STREAM_MAX_GUARDS; i++) {
+                r.guards[r.guardCount++] = { (int16_t)pos[i].x, (int16_t)pos[i].y };
+            }
+        });
+    }
+
+    StateStream* stream = nullptr;
+    const char* name = nullptr;
+    uint64_t published = 0;
+    double publishSeconds = 0;
+};
+
+extern StatePublisher statePublisher;
+extern bool publishState; // --publish-state
+
+// Opened once the arguments are parsed, so no early exit leaves the object behind
+bool OpenStateStream();
+
+// Plays and records one tick, or steps one tick back through the history while
+// rewind is held. Menus are not recorded.
+void StepGame(const PlayerInput& input, float dt);
+
+//  Fog of War 
+// Casts again only when the local thief changed tile or a door moved
+void UpdateFogOfWar();
+
+bool IsTileVisible(int x, int y);
@@ -0,0 +1,817 @@
+#include "level.h"
+
+//  Global Data 
+Level* level = nullptr;
+MazeSettings mazeSettings;
+bool useGeneratedMaze = false;
+int playerCount = 1;
+
+MazeRng rng(1);
+vector<int> questionIndices;
+
+//  Level Design 
+constexpr std::string_view LEVEL_LAYOUT[ROWS] = {
+    "11111111111111111111",
+    "19000001000000010001",
+    "10111101011111010101",
+    "10100000000000000101",
+    "10101111131111110101",
+    "10001000000000010001",
+    "11101013111101010111",
+    "10000010000001000001",
+    "10111111111111113101",
+    "10001000000000000001",
+    "10101011111131111101",
+    "10100000010000000101",
+    "10111111010111110101",
+    "10000001000000000021",
+    "11111111111111111111"
+};
+
+// The built-in layout and everything derived from it, worked out by the compiler.
+// LoadLevel copies these tables instead of parsing and flood-filling at run time.
+struct BakedLevel {
+    std::array<unsigned char, COLS * ROWS> tiles{}; // TileType per tile
+    GridPos spawn{1, 1};
+    GridPos exit{-1, -1};
+    bool walledIn = true;                            // Every edge tile is wall; checked below only
+    int freeCount = 0;                               // Walkable tiles; checked below only
+    std::array<int, COLS * ROWS> spawnDistance{};    // Same tables ComputeReachability builds
+    std::array<int, COLS * ROWS> reachable{};
+    int reachableCount = 0;
+};
+
+constexpr BakedLevel BakeLevel() {
+    BakedLevel b;
+    for (int y = 0; y < ROWS; y++) {
+        for (int x = 0; x < COLS; x++) {
+            char c = LEVEL_LAYOUT[y][x];
+            int i = y * COLS + x;
+            b.tiles[i] = (c == '1') ? TILE_WALL : (c == '2') ? TILE_EXIT : (c == '3') ? TILE_DOOR_OPEN : TILE_EMPTY;
+            if (c == '9') b.spawn = {x, y};
+            if (c == '2') b.exit = {x, y};
+            if (c == '1') continue;
+            b.freeCount++;
+            if (x == 0 || y == 0 || x == COLS - 1 || y == ROWS - 1) b.walledIn = false;
+        }
+    }
+
+    // Breadth-first from the spawn in the same neighbour order as ComputeReachability
+    for (int& d : b.spawnDistance) d = -1;
+    int start = b.spawn.y * COLS + b.spawn.x;
+    b.spawnDistance[start] = 0;
+    b.reachable[b.reachableCount++] = start;
+    for (int head = 0; head < b.reachableCount; head++) {
+        int cur = b.reachable[head];
+        for (int d = 0; d < 4; d++) {
+            int x = cur % COLS + DIR_DX[d];
+            int y = cur / COLS + DIR_DY[d];
+            if (x < 0 || x >= COLS || y < 0 || y >= ROWS) continue;
+            int n = y * COLS + x;
+            if (b.tiles[n] == TILE_WALL || b.spawnDistance[n] >= 0) continue;
+            b.spawnDistance[n] = b.spawnDistance[cur] + 1;
+            b.reachable[b.reachableCount++] = n;
+        }
+    }
+    return b;
+}
+
+constexpr BakedLevel BUILTIN_LEVEL = BakeLevel();
+
+// Layout mistakes fail the build instead of showing up in play
+static_assert(BUILTIN_LEVEL.walledIn, "the edges of the layout must be wall");
+static_assert(BUILTIN_LEVEL.exit.x >= 0, "layout needs an exit ('2')");
+static_assert(BUILTIN_LEVEL.spawnDistance[BUILTIN_LEVEL.exit.y * COLS + BUILTIN_LEVEL.exit.x] > 0,
+              "exit must be reachable from the start");
+static_assert(BUILTIN_LEVEL.reachableCount == BUILTIN_LEVEL.freeCount, "every floor tile must be reachable");
+
+//  Maze Generator 
+int MazeCols(const MazeSettings& settings) { return max(settings.cols, 5); }
+int MazeRows(const MazeSettings& settings) { return max(settings.rows, 5); }
+
+GridPos GenerateMaze(TileGrid& grid, LevelArena& arena, const MazeSettings& settings) {
+    int cols = grid.cols;
+    int rows = grid.rows;
+
+    // Carving runs on a compact cell map (one byte per cell: visited flag plus the
+    // east/south passage bits) with a border of pre-visited cells, so the random walk
+    // stays cache-friendly and needs no bounds checks. Tiles are written in one pass after.
+    const unsigned char VISITED = 1, OPEN_E = 2, OPEN_S = 4;
+    int cellW = (cols - 1) / 2;
+    int cellH = (rows - 1) / 2;
+    int stride = cellW + 2;
+    size_t mark = arena.Mark();
+    unsigned char* c = arena.Alloc<unsigned char>((size_t)stride * (cellH + 2));
+    memset(c, VISITED, (size_t)stride * (cellH + 2));
+    for (int cy = 1; cy <= cellH; cy++) memset(c + (size_t)cy * stride + 1, 0, cellW);
+
+    // Per direction (N, S, W, E): neighbour offset, and which cell/bit stores the passage
+    const int cellStep[4] = { -stride, stride, -1, 1 };
+    const int passageOwner[4] = { -stride, 0, -1, 0 };
+    const unsigned char passageBit[4] = { OPEN_S, OPEN_S, OPEN_E, OPEN_E };
+    MazeRng r(settings.seed);
+
+    // pickDir[mask][k] is the k-th set direction of a 4-bit open-neighbour mask
+    unsigned char pickDir[16][4] = {};
+    unsigned char maskCount[16] = {};
+    for (int m = 0; m < 16; m++) {
+        for (int d = 0; d < 4; d++) {
+            if (m & (1 << d)) pickDir[m][maskCount[m]++] = (unsigned char)d;
+        }
+    }
+
+    int* stack = arena.Alloc<int>((size_t)cellW * cellH);
+    ArenaArray<int> deadEnds = arena.Array<int>((size_t)cellW * cellH);
+
+    int top = 0;
+    stack[0] = stride + 1;
+    c[stride + 1] = VISITED;
+    bool fresh = true;
+
+    while (top >= 0) {
+        int cur = stack[top];
+        int mask = (~c[cur - stride] & 1) | (~c[cur + stride] & 1) << 1 | (~c[cur - 1] & 1) << 2 | (~c[cur + 1] & 1) << 3;
+
+        if (mask == 0) {
+            if (fresh) deadEnds.push_back(cur);
+            fresh = false;
+            top--;
+            continue;
+        }
+
+        int d = pickDir[mask][((uint64_t)r.Next() * maskCount[mask]) >> 32];
+        int next = cur + cellStep[d];
+        c[cur + passageOwner[d]] |= passageBit[d];
+        c[next] |= VISITED;
+        stack[++top] = next;
+        fresh = true;
+    }
+
+    // Braid: knock one extra wall out of most dead ends (only leaves of the carve need checking)
+    for (int cur : deadEnds) {
+        if (r.Chance(settings.deadEndRatio)) continue;
+
+        int cx = cur % stride;
+        int cy = cur / stride;
+        bool exitN = c[cur - stride] & OPEN_S, exitS = c[cur] & OPEN_S;
+        bool exitW = c[cur - 1] & OPEN_E, exitE = c[cur] & OPEN_E;
+        if (exitN + exitS + exitW + exitE != 1) continue;
+
+        int walls[4];
+        int wallCount = 0;
+        if (!exitN && cy > 1) walls[wallCount++] = 0;
+        if (!exitS && cy < cellH) walls[wallCount++] = 1;
+        if (!exitW && cx > 1) walls[wallCount++] = 2;
+        if (!exitE && cx < cellW) walls[wallCount++] = 3;
+        if (wallCount == 0) continue;
+
+        int d = walls[((uint64_t)r.Next() * wallCount) >> 32];
+        c[cur + passageOwner[d]] |= passageBit[d];
+    }
+
+    // Expand cells into tiles: each cell row writes its own tile row and the gap row below
+    unsigned char* t = grid.cells.data;
+    for (int cy = 1; cy <= cellH; cy++) {
+        const unsigned char* row = c + (size_t)cy * stride;
+        unsigned char* cellRow = t + (size_t)(cy * 2 - 1) * cols;
+        unsigned char* gapRow = cellRow + cols;
+        for (int cx = 1; cx <= cellW; cx++) {
+            unsigned char bits = row[cx];
+            cellRow[cx * 2 - 1] = TILE_EMPTY;
+            cellRow[cx * 2] = (unsigned char)(TILE_WALL - ((bits & OPEN_E) >> 1));
+            gapRow[cx * 2 - 1] = (unsigned char)(TILE_WALL - ((bits & OPEN_S) >> 2));
+        }
+    }
+
+    // Loops: open random walls that separate two corridors, 32 at a time. A block's
+    // pick mask is folded from random words with AND (for a 0 bit of the ratio in
+    // 1/256ths) and OR (for a 1 bit), lowest bit first, so each wall is picked with
+    // exactly that chance. Integer math only: every platform opens the same walls.
+    uint32_t ratio = (uint32_t)(std::clamp(settings.loopRatio, 0.0f, 1.0f) * 256.0f + 0.5f);
+    if (ratio > 0) {
+        int wallsPerRow = cellW - 1;                       // on cell rows (odd y)
+        int wallsPerGap = cellW;                           // on gap rows (even y)
+        long long total = (long long)cellH * wallsPerRow + (long long)(cellH - 1) * wallsPerGap;
+        int lowest = std::countr_zero(ratio);
+        long long wallsPerPair = wallsPerRow + wallsPerGap;
+        long long pairStart = 0;
+        int pair = 0;
+        for (long long base = 0; base < total; base += 32) {
+            uint32_t pick = ~0u;
+            if (ratio < 256) {
+                pick = r.Next();
+                for (int b = lowest + 1; b < 8; b++) pick = (ratio >> b & 1) ? (pick | r.Next()) : (pick & r.Next());
+            }
+            if (total - base < 32) pick &= (1u << (total - base)) - 1;
+
+            while (pick) {
+                long long i = base + std::countr_zero(pick);
+                pick &= pick - 1;
+                while (i >= pairStart + wallsPerPair) { pairStart += wallsPerPair; pair++; } // Walls come in order
+                int rem = (int)(i - pairStart);
+                int x, y;
+                if (rem < wallsPerRow) { y = pair * 2 + 1; x = rem * 2 + 2; }
+                else { y = pair * 2 + 2; x = (rem - wallsPerRow) * 2 + 1; }
+                t[(size_t)y * cols + x] = TILE_EMPTY;
+            }
+        }
+    }
+
+    // Doors go in open gaps between two cells, which are always one tile wide
+    int doorCount = min(MAX_DOORS, (int)(settings.doorRatio * cellW * cellH));
+    for (int attempt = 0; doorCount > 0 && attempt < MAX_DOORS * 20; attempt++) {
+        int x = 1 + (int)(((uint64_t)r.Next() * (cols - 2)) >> 32);
+        int y = 1 + (int)(((uint64_t)r.Next() * (rows - 2)) >> 32);
+        if ((x + y) % 2 == 0 || x >= cellW * 2 || y >= cellH * 2) continue;
+        unsigned char& tile = t[(size_t)y * cols + x];
+        if (tile != TILE_EMPTY) continue;
+        tile = TILE_DOOR_OPEN;
+        doorCount--;
+    }
+
+    t[(size_t)(cellH * 2 - 1) * cols + (cellW * 2 - 1)] = TILE_EXIT;
+    arena.Rewind(mark);
+    return {1, 1};
+}
+
+//  QUESTION BANK 
+constinit const Question questionBank[] = {
+    //SPECIAL QUESTION
+    {"Who is the best Computer programing Professor?", {"Jaudat Mamoon", "David Malan", "Andrew Ng"}, 0},
+
+    // Fun General Knowledge
+    {"Which planet has the most rings?", {"Saturn", "Jupiter", "Mars"}, 0},
+    {"What is the largest organ on the human body?", {"Liver", "Skin", "Heart"}, 1},
+    {"Who painted the Mona Lisa?", {"Van Gogh", "Picasso", "Da Vinci"}, 2},
+    {"Which country gave the Statue of Liberty to the USA?", {"France", "England", "Spain"}, 0},
+    {"What color is a polar bear's skin?", {"White", "Pink", "Black"}, 2},
+    {"In 'The Matrix', which pill does Neo take?", {"Red", "Blue", "Green"}, 0},
+    {"A group of Crows is called a...", {"Pack", "Murder", "School"}, 1},
+    {"Which is the only mammal that can fly?", {"Bat", "Flying Squirrel", "Ostrich"}, 0},
+};
+const int QUESTION_COUNT = (int)std::size(questionBank);
+
+//  Helper: Shuffle Questions & Rig the Deck 
+void ShuffleQuestions() {
+    questionIndices.clear();
+    int specialIndex = -1;
+
+    // 1. Fill list and find your special question index
+    for(int i = 0; i < QUESTION_COUNT; ++i) {
+        questionIndices.push_back(i);
+        // Identify your question by looking for "Jaudat Mamoon" in the options
+        if (questionBank[i].options[0].find("Jaudat Mamoon") != std::string_view::npos) {
+            specialIndex = i;
+        }
+    }
+
+    // 2. Shuffle everything normally (by hand: std::shuffle differs between standard
+    // libraries, and both co-op players must draw the same questions)
+    for (size_t i = questionIndices.size(); i > 1; i--) {
+        size_t j = ((uint64_t)rng.Next() * i) >> 32;
+        std::swap(questionIndices[i - 1], questionIndices[j]);
+    }
+
+    // 3. FORCE the special question to be in the "Active Zone"
+    // Since we pop from the back of the vector, the "next 3 questions" are the last 3 in the list.
+    if (specialIndex != -1) {
+        // Find where the shuffle put it
+        int currentPos = -1;
+        for(size_t i=0; i<questionIndices.size(); i++) {
+            if(questionIndices[i] == specialIndex) {
+                currentPos = i;
+                break;
+            }
+        }
+
+        // We have 3 nuggets, so we need it to be one of the last 3 items
+        int poolSize = 3;
+        if (questionIndices.size() < 3) poolSize = questionIndices.size();
+
+        // Pick a random spot in the "top 3" (which is actually the bottom 3 of the vector)
+        int randomOffset = rng() % poolSize; // 0, 1, or 2
+        int targetPos = questionIndices.size() - 1 - randomOffset;
+
+        // Swap it into place
+        std::swap(questionIndices[currentPos], questionIndices[targetPos]);
+    }
+}
+
+//  Reachability 
+void ComputeReachability(Level& lvl, GridPos from) {
+    const TileGrid& grid = lvl.grid;
+    int cols = grid.cols;
+    int rows = grid.rows;
+    lvl.spawnDistance = lvl.arena.Array<int>(grid.cells.size());
+    lvl.spawnDistance.count = grid.cells.size();
+    std::fill(lvl.spawnDistance.begin(), lvl.spawnDistance.end(), -1);
+    lvl.reachableTiles = lvl.arena.Array<int>(grid.cells.size());
+
+    int start = from.y * cols + from.x;
+    lvl.spawnDistance[start] = 0;
+    lvl.reachableTiles.push_back(start);
+
+    // reachableTiles doubles as the BFS queue
+    for (size_t head = 0; head < lvl.reachableTiles.size(); head++) {
+        int cur = lvl.reachableTiles[head];
+        int cx = cur % cols;
+        int cy = cur / cols;
+        int next[4] = { cur - cols, cur + cols, cur - 1, cur + 1 };
+        bool inside[4] = { cy > 0, cy < rows - 1, cx > 0, cx < cols - 1 };
+        for (int d = 0; d < 4; d++) {
+            int n = next[d];
+            if (inside[d] && lvl.spawnDistance[n] < 0 && grid.cells[n] != TILE_WALL) {
+                lvl.spawnDistance[n] = lvl.spawnDistance[cur] + 1;
+                lvl.reachableTiles.push_back(n);
+            }
+        }
+    }
+}
+
+// Random free reachable floor tile; false if the roll hit an occupied one
+bool PickReachableTile(Level& lvl, std::mt19937& gen, GridPos& out) {
+    if (lvl.reachableTiles.empty()) return false;
+    int idx = lvl.reachableTiles[gen() % lvl.reachableTiles.size()];
+    int x = idx % lvl.grid.cols;
+    int y = idx / lvl.grid.cols;
+
+    if (lvl.grid.cells[idx] != TILE_EMPTY) return false;
+    if (x == lvl.playerSpawn.x && y == lvl.playerSpawn.y) return false;
+    bool taken = false;
+    lvl.world.Each<Position, Pickup>([&](int n, const EntityHandle*, Position* pos, Pickup*) {
+        for (int i = 0; i < n; i++) taken |= (pos[i].x == x && pos[i].y == y);
+    });
+    if (taken) return false;
+
+    out = {x, y};
+    return true;
+}
+
+//  Wall Mesh 
+// Greedy meshing: grow each unclaimed wall tile right as far as possible, then
+// down while the whole run below is also wall, and claim the rectangle.
+void BuildWallRects(Level& lvl) {
+    const TileGrid& grid = lvl.grid;
+    size_t n = grid.cells.size();
+
+    // Claim map and rectangle list are scratch above the mark; only the rectangles are
+    // kept, copied down to the mark once their final count is known
+    size_t mark = lvl.arena.Mark();
+    unsigned char* claimed = lvl.arena.Alloc<unsigned char>(n);
+    memset(claimed, 0, n);
+    ArenaArray<Rectangle> rects = lvl.arena.Array<Rectangle>(n);
+    lvl.wallTileCount = 0;
+
+    for (int y = 0; y < grid.rows; y++) {
+        for (int x = 0; x < grid.cols; x++) {
+            int idx = y * grid.cols + x;
+            if (grid.cells[idx] != TILE_WALL || claimed[idx]) continue;
+
+            int w = 1;
+            while (x + w < grid.cols && grid.cells[idx + w] == TILE_WALL && !claimed[idx + w]) w++;
+
+            int h = 1;
+            while (y + h < grid.rows) {
+                int row = (y + h) * grid.cols + x;
+                bool full = true;
+                for (int i = 0; i < w && full; i++) full = grid.cells[row + i] == TILE_WALL && !claimed[row + i];
+                if (!full) break;
+                h++;
+            }
+
+            for (int j = 0; j < h; j++) memset(&claimed[(y + j) * grid.cols + x], 1, w);
+            rects.push_back({(float)x, (float)y, (float)w, (float)h});
+            lvl.wallTileCount += w * h;
+        }
+    }
+
+    lvl.arena.Rewind(mark);
+    lvl.wallRects = lvl.arena.Array<Rectangle>(rects.size());
+    memmove(lvl.wallRects.data, rects.data, rects.size() * sizeof(Rectangle));
+    lvl.wallRects.count = rects.size();
+}
+
+// Collects vertices for one mesh chunk
+struct WallMeshBuilder {
+    vector<float> vertices;
+    vector<unsigned char> colors;
+    vector<unsigned short> indices;
+
+    int VertexCount() const { return (int)vertices.size() / 3; }
+
+    unsigned short Vertex(float x, float y, Color c) {
+        vertices.insert(vertices.end(), { x, y, 0.0f });
+        colors.insert(colors.end(), { c.r, c.g, c.b, c.a });
+        return (unsigned short)(VertexCount() - 1);
+    }
+
+    // Rounded rectangle as a fan around its centre: one centre vertex plus the outline
+    void RoundedRect(Rectangle r, float radius, Color c) {
+        unsigned short center = Vertex(r.x + r.width / 2, r.y + r.height / 2, c);
+        const Vector2 corners[4] = {
+            { r.x + radius, r.y + radius }, { r.x + r.width - radius, r.y + radius },
+            { r.x + r.width - radius, r.y + r.height - radius }, { r.x + radius, r.y + r.height - radius }
+        };
+        int outline = 4 * (WALL_CORNER_SEGMENTS + 1);
+        for (int k = 0; k < 4; k++) {
+            float start = (180.0f + 90.0f * k) * DEG2RAD;
+            for (int i = 0; i <= WALL_CORNER_SEGMENTS; i++) {
+                float a = start + (90.0f * DEG2RAD) * i / WALL_CORNER_SEGMENTS;
+                Vertex(corners[k].x + cosf(a) * radius, corners[k].y + sinf(a) * radius, c);
+            }
+        }
+        for (int i = 0; i < outline; i++) {
+            indices.insert(indices.end(), { center, (unsigned short)(center + 1 + i), (unsigned short)(center + 1 + (i + 1) % outline) });
+        }
+    }
+
+    void Quad(Rectangle r, Color c) {
+        unsigned short a = Vertex(r.x, r.y, c);
+        Vertex(r.x + r.width, r.y, c);
+        Vertex(r.x + r.width, r.y + r.height, c);
+        Vertex(r.x, r.y + r.height, c);
+        indices.insert(indices.end(), { a, (unsigned short)(a + 1), (unsigned short)(a + 2), a, (unsigned short)(a + 2), (unsigned short)(a + 3) });
+    }
+
+    // Moves the collected data into a raylib mesh (arrays owned by MemAlloc, as UnloadMesh expects)
+    void Flush(ArenaArray<WallMeshChunk>& out, Rectangle bounds) {
+        if (vertices.empty()) return;
+        WallMeshChunk chunk;
+        chunk.bounds = bounds;
+        chunk.mesh.vertexCount = VertexCount();
+        chunk.mesh.triangleCount = (int)indices.size() / 3;
+        chunk.mesh.vertices = (float*)MemAlloc(vertices.size() * sizeof(float));
+        chunk.mesh.colors = (unsigned char*)MemAlloc(colors.size());
+        chunk.mesh.indices = (unsigned short*)MemAlloc(indices.size() * sizeof(unsigned short));
+        memcpy(chunk.mesh.vertices, vertices.data(), vertices.size() * sizeof(float));
+        memcpy(chunk.mesh.colors, colors.data(), colors.size());
+        memcpy(chunk.mesh.indices, indices.data(), indices.size() * sizeof(unsigned short));
+        out.push_back(chunk);
+        vertices.clear();
+        colors.clear();
+        indices.clear();
+    }
+};
+
+// Bakes shadow, body and highlight of every merged wall rectangle into static meshes.
+// Pure CPU work so it runs with the rest of LoadLevel; the upload happens on install.
+void BuildWallMesh(Level& lvl) {
+    const int perRect = 2 * (1 + 4 * (WALL_CORNER_SEGMENTS + 1)) + 4;
+    const size_t rectsPerChunk = MESH_MAX_VERTICES / perRect;
+    const Color highlight = Fade(WHITE, 0.05f);
+    WallMeshBuilder b;
+    lvl.wallVertexCount = 0;
+    lvl.wallMeshes = lvl.arena.Array<WallMeshChunk>((lvl.wallRects.size() + rectsPerChunk - 1) / rectsPerChunk);
+
+    size_t first = 0;
+    while (first < lvl.wallRects.size()) {
+        size_t last = min(lvl.wallRects.size(), first + rectsPerChunk);
+
+        // Layer order inside a chunk: all shadows, then bodies, then highlights
+        Rectangle bounds = { 1e30f, 1e30f, -1e30f, -1e30f };
+        for (int layer = 0; layer < 3; layer++) {
+            for (size_t i = first; i < last; i++) {
+                const Rectangle& t = lvl.wallRects[i];
+                Rectangle r = { t.x * TILE_SIZE, t.y * TILE_SIZE + UI_HEIGHT, t.width * TILE_SIZE, t.height * TILE_SIZE };
+                if (layer == 0) {
+                    b.RoundedRect({ r.x + 4, r.y + 4, r.width, r.height }, WALL_RADIUS, COL_WALL_SHADOW);
+                    bounds.x = min(bounds.x, r.x);
+                    bounds.y = min(bounds.y, r.y);
+                    bounds.width = max(bounds.width, r.x + r.width + 4);
+                    bounds.height = max(bounds.height, r.y + r.height + 4);
+                }
+                else if (layer == 1) b.RoundedRect(r, WALL_RADIUS, COL_WALL);
+                else b.Quad({ r.x + 5, r.y + 5, r.width - 10, TILE_SIZE / 3.0f }, highlight);
+            }
+        }
+        bounds.width -= bounds.x;
+        bounds.height -= bounds.y;
+        lvl.wallVertexCount += b.VertexCount();
+        b.Flush(lvl.wallMeshes, bounds);
+        first = last;
+    }
+}
+
+void UploadLevelGpu(Level& lvl) {
+    for (auto& chunk : lvl.wallMeshes) UploadMesh(&chunk.mesh, false);
+    lvl.gpuReady = true;
+}
+
+void UnloadLevelGpu(Level& lvl) {
+    if (!lvl.gpuReady) return;
+    for (auto& chunk : lvl.wallMeshes) {
+        UnloadMesh(chunk.mesh); // Frees the CPU arrays too
+        chunk.mesh = {};
+    }
+    lvl.gpuReady = false;
+}
+
+//  Patrol Routes 
+// Breadth-first over open tiles, skipping any tile with blocked[i] set
+void RouteSearch(const TileGrid& grid, int from, const unsigned char* blocked, int* dist, int* parent, int* queue) {
+    int cols = grid.cols;
+    int rows = grid.rows;
+    std::fill(dist, dist + grid.cells.size(), -1);
+    dist[from] = 0;
+    parent[from] = from;
+    int head = 0;
+    int tail = 0;
+    queue[tail++] = from;
+    while (head < tail) {
+        int cur = queue[head++];
+        int cx = cur % cols;
+        int cy = cur / cols;
+        int next[4] = { cur - cols, cur + cols, cur - 1, cur + 1 };
+        bool inside[4] = { cy > 0, cy < rows - 1, cx > 0, cx < cols - 1 };
+        for (int d = 0; d < 4; d++) {
+            int n = next[d];
+            if (!inside[d] || dist[n] >= 0 || grid.cells[n] == TILE_WALL || IsDoorTile(grid.cells[n]) || blocked[n]) continue;
+            dist[n] = dist[cur] + 1;
+            parent[n] = cur;
+            queue[tail++] = n;
+        }
+    }
+}
+
+// Out to a tile a few steps away and back by another way if there is one, otherwise
+// back the same way. Writes the loop as tile indices and returns its length.
+int BuildPatrolLoop(const TileGrid& grid, int start, std::mt19937& gen, int* route,
+                    int* dist, int* parent, int* queue, unsigned char* blocked) {
+    const size_t n = grid.cells.size();
+    std::fill(blocked, blocked + n, 0);
+    RouteSearch(grid, start, blocked, dist, parent, queue);
+
+    // Far end: a random tile in the reach band, else the farthest one reached
+    int candidates = 0;
+    int farthest = start;
+    for (size_t i = 0; i < n; i++) {
+        if (dist[i] >= PATROL_REACH_MIN && dist[i] <= PATROL_REACH_MAX) candidates++;
+        if (dist[i] > dist[farthest] && dist[i] <= PATROL_REACH_MAX) farthest = (int)i;
+    }
+    int end = farthest;
+    if (candidates > 0) {
+        int pick = (int)(gen() % candidates);
+        for (size_t i = 0; i < n; i++) {
+            if (dist[i] >= PATROL_REACH_MIN && dist[i] <= PATROL_REACH_MAX && pick-- == 0) { end = (int)i; break; }
+        }
+    }
+
+    // Outbound leg, start to end
+    int outLength = dist[end];
+    for (int t = end, i = outLength; i >= 0; t = parent[t], i--) route[i] = t;
+    if (outLength == 0) return 1;
+
+    // Return leg avoiding the outbound tiles, so the loop goes round a block
+    for (int i = 1; i < outLength; i++) blocked[route[i]] = 1;
+    RouteSearch(grid, end, blocked, dist, parent, queue);
+    int backLength = dist[start];
+    if (backLength > 1 && outLength + backLength <= MAX_ROUTE_LENGTH) {
+        int length = outLength + backLength;
+        for (int t = parent[start], i = length - 1; t != end; t = parent[t], i--) route[i] = t;
+        return length;
+    }
+
+    // Dead end: walk back along the same corridor
+    for (int i = 1; i < outLength; i++) route[outLength + i] = route[outLength - i];
+    return 2 * outLength;
+}
+
+void CompilePatrolRoutes(Level& lvl, const int* spawnTiles, int guards, std::mt19937& gen) {
+    const TileGrid& grid = lvl.grid;
+    const size_t n = grid.cells.size();
+    lvl.routes = lvl.arena.Array<PatrolRoute>(guards);
+    lvl.routeTiles = lvl.arena.Array<int>((size_t)guards * MAX_ROUTE_LENGTH);
+    lvl.routeSteps = lvl.arena.Array<unsigned char>((size_t)guards * n);
+    lvl.routeSteps.count = (size_t)guards * n;
+    lvl.routeFields = lvl.arena.Array<DistanceField>(guards);
+    lvl.routeFields.count = guards;
+    for (auto& field : lvl.routeFields) field = DistanceField();
+    lvl.fieldQueue.Init(lvl.arena, n);
+
+    size_t mark = lvl.arena.Mark();
+    int* dist = lvl.arena.Alloc<int>(n);
+    int* parent = lvl.arena.Alloc<int>(n);
+    int* queue = lvl.arena.Alloc<int>(n);
+    unsigned char* blocked = lvl.arena.Alloc<unsigned char>(n);
+
+    for (int g = 0; g < guards; g++) {
+        PatrolRoute route = { (int)lvl.routeTiles.size(), 0 };
+        route.length = BuildPatrolLoop(grid, spawnTiles[g], gen, lvl.routeTiles.data + route.first, dist, parent, queue, blocked);
+        lvl.routeTiles.count += route.length;
+        lvl.routes.push_back(route);
+
+        // Tiles on the loop know their position; the field leads everywhere else back to it
+        unsigned char* steps = lvl.routeSteps.data + (size_t)g * n;
+        std::fill(steps, steps + n, ROUTE_OFF);
+        for (int i = 0; i < route.length; i++) {
+            int tile = lvl.routeTiles[route.first + i];
+            if (steps[tile] == ROUTE_OFF) steps[tile] = (unsigned char)i;
+        }
+    }
+    lvl.arena.Rewind(mark);
+
+    // Fields last, above the scratch that was just given back
+    for (int g = 0; g < guards; g++) {
+        DistanceField& field = lvl.routeFields[g];
+        field.Init(lvl.arena, n);
+        const PatrolRoute& route = lvl.routes[g];
+        for (int i = 0; i < route.length; i++) field.source[lvl.routeTiles[route.first + i]] = 1;
+        field.Build(grid, lvl.fieldQueue);
+    }
+}
+
+//  Initialization 
+size_t LevelArenaBytes(int cols, int rows) {
+    size_t n = (size_t)cols * rows;
+    const size_t perRect = 2 * (1 + 4 * (WALL_CORNER_SEGMENTS + 1)) + 4;
+    size_t chunks = n / (MESH_MAX_VERTICES / perRect) + 1;
+    size_t patrols = GUARD_COUNT * (sizeof(PatrolRoute) + MAX_ROUTE_LENGTH * sizeof(int) + n) + n * (3 * sizeof(int) + 1);
+    size_t fields = GUARD_COUNT * (sizeof(DistanceField) + n * (2 * sizeof(FieldDistance) + 1) + 16) +
+                    n * (2 * sizeof(int) + sizeof(FieldDistance));
+    return n * (sizeof(unsigned char) + 2 * sizeof(int)) + n * (1 + sizeof(Rectangle)) + chunks * sizeof(WallMeshChunk) +
+           patrols + fields + MAX_DOORS * sizeof(int) + n * sizeof(NoiseCell) + 2 * n +
+           (2 * VIEW_RADIUS + 1) * (2 * VIEW_RADIUS + 1) * sizeof(int) + 256;
+}
+
+// Animation offset for a pickup, hashed from its tile so spawns use no extra dice
+AnimPhase PhaseForTile(int x, int y) {
+    uint32_t h = (uint32_t)x * 0x9E3779B1u ^ (uint32_t)y * 0x85EBCA77u;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    float angle = (h >> 8) * (2.0f * PI / 16777216.0f);
+    return { angle * RAD2DEG, sinf(angle), cosf(angle) };
+}
+
+void LoadLevel(Level& out, const LevelRecipe& recipe) {
+    int cols = recipe.generated ? MazeCols(recipe.maze) : COLS;
+    int rows = recipe.generated ? MazeRows(recipe.maze) : ROWS;
+
+    // Own engine per build: rand() is shared state and the worker must not touch it
+    std::mt19937 gen(recipe.maze.seed ^ 0x5bd1e995u);
+
+    // Recycled levels keep their arena block, so same-sized maps never allocate here
+    out.Clear();
+    out.arena.Reserve(LevelArenaBytes(cols, rows));
+
+    TileGrid& grid = out.grid;
+    grid.Resize(out.arena, cols, rows, TILE_WALL);
+    out.playerSpawn = {1, 1};
+
+    if (recipe.generated) {
+        out.playerSpawn = GenerateMaze(grid, out.arena, recipe.maze);
+
+        // One flood fill from the spawn; everything below only picks reachable tiles
+        ComputeReachability(out, out.playerSpawn);
+    } else {
+        // Built-in layout: tiles and flood fill were baked at compile time
+        const size_t n = grid.cells.size();
+        memcpy(grid.cells.data, BUILTIN_LEVEL.tiles.data(), n);
+        out.playerSpawn = BUILTIN_LEVEL.spawn;
+        out.spawnDistance = out.arena.Array<int>(n);
+        out.spawnDistance.count = n;
+        memcpy(out.spawnDistance.data, BUILTIN_LEVEL.spawnDistance.data(), n * sizeof(int));
+        out.reachableTiles = out.arena.Array<int>(n);
+        out.reachableTiles.count = BUILTIN_LEVEL.reachableCount;
+        memcpy(out.reachableTiles.data, BUILTIN_LEVEL.reachable.data(), BUILTIN_LEVEL.reachableCount * sizeof(int));
+    }
+    const ArenaArray<int>& reachable = out.reachableTiles;
+
+    // The exit must be reachable; otherwise move it to the farthest reachable tile
+    bool exitReachable = false;
+    for (int i : reachable) {
+        if (grid.cells[i] == TILE_EXIT) { exitReachable = true; break; }
+    }
+    if (!exitReachable && reachable.size() > 1) {
+        for (auto& cell : grid.cells) if (cell == TILE_EXIT) cell = TILE_EMPTY;
+        grid.cells[reachable.back()] = TILE_EXIT;
+    }
+
+    // Doors start open; any past what a snapshot can track become floor
+    out.doors = out.arena.Array<int>(MAX_DOORS);
+    for (size_t i = 0; i < grid.cells.size(); i++) {
+        if (!IsDoorTile(grid.cells[i])) continue;
+        if (out.doors.size() < (size_t)MAX_DOORS) out.doors.push_back((int)i);
+        else grid.cells[i] = TILE_EMPTY;
+    }
+
+    // Spawn Diamonds
+    int diamondCount = 0;
+    int attempts = 0;
+    while (diamondCount < 5 && attempts++ < 10000) {
+        GridPos p;
+        if (PickReachableTile(out, gen, p)) {
+            out.world.Spawn(Position{p.x, p.y}, Pickup{PICKUP_DIAMOND}, PhaseForTile(p.x, p.y));
+            diamondCount++;
+        }
+    }
+
+    // Spawn Nuggets (Quiz triggers)
+    int nuggetCount = 0;
+    attempts = 0;
+    while (nuggetCount < 3 && attempts++ < 10000) {
+        GridPos p;
+        if (PickReachableTile(out, gen, p)) {
+            out.world.Spawn(Position{p.x, p.y}, Pickup{PICKUP_NUGGET}, PhaseForTile(p.x, p.y));
+            nuggetCount++;
+        }
+    }
+
+    // Spawn Enemies: more than 8 steps away by path, not as the crow flies.
+    // The reachable list is in BFS order, so the candidates are one contiguous tail.
+    // One guard per tile; a small maze with few such tiles gets fewer guards, and
+    // one with none gets none rather than guards within reach of the spawn.
+    size_t firstFar = 0;
+    while (firstFar < reachable.size() && out.spawnDistance[reachable[firstFar]] <= 8) firstFar++;
+    size_t farCount = reachable.size() - firstFar;
+
+    int enemyCount = 0;
+    int guardTiles[GUARD_COUNT];
+    attempts = 0;
+    while (enemyCount < (int)min<size_t>(GUARD_COUNT, farCount)) {
+        int idx = reachable[firstFar + gen() % farCount];
+        bool taken = std::find(guardTiles, guardTiles + enemyCount, idx) != guardTiles + enemyCount;
+        if (taken && attempts++ < 1000) continue;
+        if (taken) break; // Out of tries on a nearly full tail
+        if (IsDoorTile(grid.cells[idx]) && attempts++ < 1000) continue; // Loops start off the doors
+        int ex = idx % grid.cols;
+        int ey = idx / grid.cols;
+        Guard guard = {};
+        guard.route = (uint8_t)enemyCount;
+        guard.wander = recipe.maze.seed ^ (0x9E3779B9u * (enemyCount + 1)); // MazeRng replaces 0
+        // 0.28-0.68 s per step from 24 bits of one draw; a distribution object would
+        // roll differently on each standard library and split co-op between builds
+        float speed = 0.28f + 0.40f * (float)(gen() >> 8) * (1.0f / 16777216.0f);
+        out.world.Spawn(Position{ex, ey}, MoveTimer{0.0f}, Speed{speed}, guard);
+        guardTiles[enemyCount++] = idx;
+    }
+
+    // Own engine for the loops, so spawns come out the same as before patrols existed
+    std::mt19937 routeGen(recipe.maze.seed ^ 0x27d4eb2fu);
+    CompilePatrolRoutes(out, guardTiles, enemyCount, routeGen);
+
+    out.noise = out.arena.Array<NoiseCell>(grid.cells.size());
+    out.noise.count = grid.cells.size();
+    memset(out.noise.data, 0, out.noise.count * sizeof(NoiseCell));
+
+    // Nothing seen yet: black everywhere
+    out.fog.pixels = out.arena.Array<unsigned char>(2 * grid.cells.size());
+    out.fog.pixels.count = out.fog.pixels.capacity;
+    for (size_t i = 0; i < out.fog.pixels.count; i += 2) {
+        out.fog.pixels[i] = 0;
+        out.fog.pixels[i + 1] = FOG_UNSEEN;
+    }
+    out.fog.lit = out.arena.Array<int>((2 * VIEW_RADIUS + 1) * (2 * VIEW_RADIUS + 1));
+
+    out.diamondsLeft = diamondCount;
+    for (int p = 0; p < recipe.players; p++) {
+        out.players[p] = out.world.Spawn(Position{out.playerSpawn.x, out.playerSpawn.y}, MoveTimer{0.0f}, Stamina{100.0f},
+                                         MoveIntent{DIR_NONE, 0.0}, Controlled{(uint8_t)p});
+    }
+
+    BuildWallRects(out);
+    BuildWallMesh(out);
+}
+
+//  Level Pipeline 
+void LevelPipeline::Run() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        wake.wait(lock, [this] { return quit || hasJob || !retired.empty(); });
+        if (quit) break;
+
+        spare.insert(spare.end(), retired.begin(), retired.end());
+        retired.clear();
+        bool build = hasJob;
+        LevelRecipe recipe = job;
+        hasJob = false;
+        building = build;
+        Level* next = nullptr;
+        if (build && !spare.empty()) {
+            next = spare.back();
+            spare.pop_back();
+        }
+        lock.unlock();
+
+        if (build) {
+            if (!next) next = new Level;
+            LoadLevel(*next, recipe);
+            Level* stale = ready.exchange(next); // A stale unclaimed build is simply replaced
+            if (stale) Retire(stale);
+        }
+
+        lock.lock();
+        building = false;
+        done.notify_all();
+    }
+    for (Level* old : retired) delete old;
+    retired.clear();
+}
+
+LevelPipeline levelPipeline;
+
+LevelRecipe NextLevelRecipe() {
+    LevelRecipe recipe = { useGeneratedMaze, mazeSettings, playerCount };
+    mazeSettings.seed++;
+    return recipe;
+}
@@ -0,0 +1,502 @@
+// Level data and generation: tile grid, guard route fields, the maze generator,
+// LoadLevel and the worker thread that builds the next level in the background.
+#pragma once
+
+#include "ecs.h"
+
+// Flat tile storage sized at load time; gameGrid[y][x] indexing still works
+struct TileGrid {
+    int cols = 0;
+    int rows = 0;
+    ArenaArray<unsigned char> cells;
+
+    void Resize(LevelArena& arena, int c, int r, unsigned char fill) {
+        cols = c;
+        rows = r;
+        cells = arena.Array<unsigned char>((size_t)c * r);
+        cells.count = cells.capacity;
+        memset(cells.data, fill, cells.count);
+    }
+    unsigned char* operator[](int y) { return &cells[(size_t)y * cols]; }
+    const unsigned char* operator[](int y) const { return &cells[(size_t)y * cols]; }
+};
+
+//  Incremental Distance Fields 
+// Step counts from every tile to the nearest source tile that stay right as doors
+// open and close. This is LPA* searching backwards from the sources without a
+// heuristic, i.e. the whole-map form of D* Lite: each tile keeps its distance g and
+// a lookahead rhs (0 on sources, else 1 + the smallest g among its open neighbours).
+// A door toggle only changes rhs around the door; the queue then settles just the
+// tiles whose distance really changes instead of the whole map.
+//
+// 32-bit: corridors in a braided maze thousands of tiles on a side run past 65535 steps
+using FieldDistance = uint32_t;
+const FieldDistance FIELD_FAR = 0xFFFFFFFFu; // Unreachable
+
+// Min-heap of tiles keyed by distance that knows where every tile sits, so entries
+// can be re-keyed or dropped in place. A level shares one between its fields:
+// every update drains it before the next one starts.
+struct FieldQueue {
+    int* tiles = nullptr;
+    FieldDistance* keys = nullptr;
+    int* slot = nullptr; // Per tile: heap position, -1 when not queued
+    int size = 0;
+
+    void Init(LevelArena& arena, size_t n) {
+        tiles = arena.Alloc<int>(n);
+        keys = arena.Alloc<FieldDistance>(n);
+        slot = arena.Alloc<int>(n);
+        std::fill(slot, slot + n, -1);
+        size = 0;
+    }
+
+    bool Empty() const { return size == 0; }
+
+    // Queues the tile, or moves it if it is already queued
+    void Set(int tile, FieldDistance key) {
+        int i = slot[tile];
+        if (i < 0) {
+            i = size++;
+            Place(i, tile, key);
+        } else {
+            keys[i] = key;
+        }
+        Down(Up(i));
+    }
+
+    void Remove(int tile) {
+        int i = slot[tile];
+        if (i < 0) return;
+        slot[tile] = -1;
+        if (--size == i) return;
+        Place(i, tiles[size], keys[size]);
+        Down(Up(i));
+    }
+
+    int Pop() {
+        int top = tiles[0];
+        Remove(top);
+        return top;
+    }
+
+private:
+    void Place(int i, int tile, FieldDistance key) {
+        tiles[i] = tile;
+        keys[i] = key;
+        slot[tile] = i;
+    }
+
+    int Up(int i) {
+        while (i > 0 && keys[(i - 1) / 2] > keys[i]) {
+            Swap(i, (i - 1) / 2);
+            i = (i - 1) / 2;
+        }
+        return i;
+    }
+
+    void Down(int i) {
+        while (true) {
+            int least = i;
+            int l = 2 * i + 1;
+            int r = l + 1;
+            if (l < size && keys[l] < keys[least]) least = l;
+            if (r < size && keys[r] < keys[least]) least = r;
+            if (least == i) return;
+            Swap(i, least);
+            i = least;
+        }
+    }
+
+    void Swap(int a, int b) {
+        int ta = tiles[a];
+        FieldDistance ka = keys[a];
+        Place(a, tiles[b], keys[b]);
+        Place(b, ta, ka);
+    }
+};
+
+struct DistanceField {
+    FieldDistance* g = nullptr;
+    FieldDistance* rhs = nullptr;
+    unsigned char* source = nullptr; // Non-zero on the tiles distances are measured to
+    long long settled = 0;           // Tiles taken off the queue, for the stats
+
+    void Init(LevelArena& arena, size_t n) {
+        g = arena.Alloc<FieldDistance>(n);
+        rhs = arena.Alloc<FieldDistance>(n);
+        source = arena.Alloc<unsigned char>(n);
+        std::fill(source, source + n, 0);
+    }
+
+    // From scratch: with everything unknown this is plain Dijkstra
+    void Build(const TileGrid& grid, FieldQueue& queue) {
+        size_t n = grid.cells.size();
+        std::fill(g, g + n, FIELD_FAR);
+        std::fill(rhs, rhs + n, FIELD_FAR);
+        for (size_t i = 0; i < n; i++) {
+            if (source[i] && IsOpenTile(grid.cells[i])) {
+                rhs[i] = 0;
+                queue.Set((int)i, 0);
+            }
+        }
+        Settle(grid, queue);
+    }
+
+    // The tile opened or closed: only it and its neighbours get a new lookahead
+    void Changed(const TileGrid& grid, int tile, FieldQueue& queue) {
+        Update(grid, tile, queue);
+        ForNeighbours(grid, tile, [&](int nb) { Update(grid, nb, queue); });
+        Settle(grid, queue);
+    }
+
+    // Direction of the first step towards the nearest source, or DIR_NONE
+    int StepFrom(const TileGrid& grid, int tile) const {
+        int best = DIR_NONE;
+        FieldDistance bestDistance = g[tile];
+        int cx = tile % grid.cols;
+        int cy = tile / grid.cols;
+        for (int d = 0; d < 4; d++) {
+            int x = cx + DIR_DX[d];
+            int y = cy + DIR_DY[d];
+            if (x < 0 || x >= grid.cols || y < 0 || y >= grid.rows) continue;
+            int nb = y * grid.cols + x;
+            if (g[nb] < bestDistance) {
+                bestDistance = g[nb];
+                best = d;
+            }
+        }
+        return best;
+    }
+
+private:
+    template <typename Fn>
+    static void ForNeighbours(const TileGrid& grid, int tile, Fn fn) {
+        int cx = tile % grid.cols;
+        int cy = tile / grid.cols;
+        if (cy > 0) fn(tile - grid.cols);
+        if (cy < grid.rows - 1) fn(tile + grid.cols);
+        if (cx > 0) fn(tile - 1);
+        if (cx < grid.cols - 1) fn(tile + 1);
+    }
+
+    void Update(const TileGrid& grid, int tile, FieldQueue& queue) {
+        FieldDistance lookahead = FIELD_FAR;
+        if (IsOpenTile(grid.cells[tile])) {
+            if (source[tile]) {
+                lookahead = 0;
+            } else {
+                ForNeighbours(grid, tile, [&](int nb) {
+                    if (g[nb] != FIELD_FAR) lookahead = min<FieldDistance>(lookahead, g[nb] + 1);
+                });
+            }
+        }
+        rhs[tile] = lookahead;
+        if (g[tile] != rhs[tile]) queue.Set(tile, min(g[tile], rhs[tile]));
+        else queue.Remove(tile);
+    }
+
+    void Settle(const TileGrid& grid, FieldQueue& queue) {
+        while (!queue.Empty()) {
+            int tile = queue.Pop();
+            settled++;
+            if (g[tile] > rhs[tile]) {
+                g[tile] = rhs[tile]; // Got closer: fix it and let the neighbours catch up
+            } else {
+                g[tile] = FIELD_FAR; // Got farther: forget it and work it out again
+                Update(grid, tile, queue);
+            }
+            ForNeighbours(grid, tile, [&](int nb) { Update(grid, nb, queue); });
+        }
+    }
+};
+
+const int MAX_DOORS = 64; // Snapshots keep which doors are open in one 64-bit mask
+
+struct MazeSettings {
+    int cols = COLS;
+    int rows = ROWS;
+    uint32_t seed = 0;
+    float loopRatio = 0.08f;    // Chance to knock out any wall between two corridors
+    float deadEndRatio = 0.25f; // Share of dead ends that survive the braiding pass
+    float doorRatio = 0.02f;    // Share of corridors between two cells that get a door
+};
+
+// One guard's loop: routeTiles[first .. first + length) in walking order
+struct PatrolRoute {
+    int first;
+    int length;
+};
+
+// Loudest recent noise heard on a tile, plus scratch for spreading the next one
+struct NoiseCell {
+    float amplitude; // Loudness when it arrived
+    float time;      // Noise clock when it was made
+    uint32_t epoch;  // Stale unless it matches the field's epoch
+    uint32_t visit;  // Last spread that queued this tile
+    uint8_t cost;    // Cheapest cost found by that spread
+};
+
+// What the local thief can see, kept as a tile-sized gray + alpha image that is
+// drawn over the map as one filtered quad (see UpdateFogOfWar)
+const int VIEW_RADIUS = 8;                 // Tiles
+const unsigned char FOG_UNSEEN = 255;      // Overlay alpha per tile
+const unsigned char FOG_REMEMBERED = 150;
+const unsigned char FOG_VISIBLE = 0;
+
+struct FogOfWar {
+    ArenaArray<unsigned char> pixels; // Two bytes per tile, the second is the darkness
+    ArenaArray<int> lit;              // Tiles the last cast lit, dimmed again before the next
+    int castTile = -1;                // Where the last cast was made from
+    uint32_t castDoors = 0;           // Level::doorVersion at that cast
+};
+
+// Part of the static wall mesh. A mesh holds at most 65535 vertices (16-bit indices),
+// so big maps are split into horizontal bands that can also be culled.
+struct WallMeshChunk {
+    Mesh mesh = {};
+    Rectangle bounds = {}; // World space, used to skip bands outside the view
+};
+
+// Everything a level owns. Built off the main thread and swapped in as one pointer.
+// Entities live in the level's world and all tile-sized data in the arena, so a Level
+// is reused for later builds instead of being freed.
+struct Level {
+    Level() = default;
+    Level(const Level&) = delete;
+    Level& operator=(const Level&) = delete;
+    ~Level() { FreeMeshArrays(); }
+
+    // Empties the level for another build; keeps the arena block and invalidates every entity handle
+    void Clear() {
+        FreeMeshArrays();
+        world.Clear();
+        for (auto& p : players) p = NO_ENTITY;
+        diamondsLeft = 0;
+        grid = TileGrid();
+        spawnDistance = ArenaArray<int>();
+        reachableTiles = ArenaArray<int>();
+        wallRects = ArenaArray<Rectangle>();
+        wallMeshes = ArenaArray<WallMeshChunk>();
+        routes = ArenaArray<PatrolRoute>();
+        routeTiles = ArenaArray<int>();
+        routeSteps = ArenaArray<unsigned char>();
+        noise = ArenaArray<NoiseCell>();
+        doors = ArenaArray<int>();
+        routeFields = ArenaArray<DistanceField>();
+        fieldQueue = FieldQueue();
+        doorVersion = 0;
+        fog = FogOfWar();
+        wallTileCount = 0;
+        wallVertexCount = 0;
+        gpuReady = false;
+        arena.Reset();
+    }
+
+    // CPU-side mesh copies still held here; after an upload UnloadLevelGpu has already freed them
+    void FreeMeshArrays() {
+        for (auto& chunk : wallMeshes) {
+            MemFree(chunk.mesh.vertices);
+            MemFree(chunk.mesh.colors);
+            MemFree(chunk.mesh.indices);
+            chunk.mesh = {};
+        }
+    }
+
+    LevelArena arena;
+    TileGrid grid;
+    GridPos playerSpawn;
+    World world;
+    EntityHandle players[MAX_PLAYERS] = { NO_ENTITY, NO_ENTITY }; // By player index; unused seats stay NO_ENTITY
+    int diamondsLeft = 0;
+
+    // Flood fill from the spawn, kept so other systems can reuse it
+    ArenaArray<int> spawnDistance;  // Path length from the player spawn per tile, -1 if sealed off
+    ArenaArray<int> reachableTiles; // Tile indices in BFS order, i.e. sorted by spawnDistance
+
+    // Guard patrols, one per guard (see CompilePatrolRoutes)
+    ArenaArray<PatrolRoute> routes;
+    ArenaArray<int> routeTiles;           // Every loop back to back, as tile indices
+    ArenaArray<unsigned char> routeSteps; // Per route and tile: position on the loop, or ROUTE_OFF
+    ArenaArray<DistanceField> routeFields; // Per route: steps back to the loop, repaired as doors move
+    FieldQueue fieldQueue;                 // Shared by the route fields
+
+    ArenaArray<int> doors;       // Door tiles in row order, at most MAX_DOORS
+    uint32_t doorVersion = 0;    // Bumped whenever one opens or closes
+    FogOfWar fog;
+    ArenaArray<NoiseCell> noise; // Per tile, written by the NoiseField
+
+    // Walls merged into maximal rectangles (in tiles) and baked into a static mesh
+    ArenaArray<Rectangle> wallRects;
+    ArenaArray<WallMeshChunk> wallMeshes;
+    int wallTileCount = 0;
+    int wallVertexCount = 0;
+    bool gpuReady = false;
+};
+
+// What to build: fixed layout or a maze, plus the seed for maze and spawns
+struct LevelRecipe {
+    bool generated = false;
+    MazeSettings maze;
+    int players = 1;
+};
+
+// xorshift32: tiny state and plenty random enough for carving and for the rules.
+// Four bytes of state also keep game snapshots small.
+struct MazeRng {
+    using result_type = uint32_t;
+    uint32_t state;
+    explicit MazeRng(uint32_t seed) : state(seed ? seed : 0x9E3779B9u) {}
+    static constexpr uint32_t min() { return 1; }
+    static constexpr uint32_t max() { return 0xFFFFFFFFu; }
+    uint32_t operator()() { return Next(); }
+    uint32_t Next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    bool Chance(float p) { return (Next() >> 8) < (uint32_t)(p * 16777216.0f); }
+};
+
+//  Global Data 
+extern Level* level;
+extern MazeSettings mazeSettings;
+extern bool useGeneratedMaze;
+extern int playerCount;       // 2 in co-op
+
+// Random engine setup
+extern MazeRng rng;
+extern vector<int> questionIndices; // To track which questions have been used
+
+//  Maze Generator 
+// Recursive backtracker (iterative, explicit stack) over the odd-coordinate cells,
+// then a braiding pass that opens dead ends, a loop pass that opens extra walls and
+// a few doors.
+
+// Map size a maze is generated at; anything smaller than 5x5 is raised to it
+int MazeCols(const MazeSettings& settings);
+int MazeRows(const MazeSettings& settings);
+
+// Writes TileType values straight into the level's grid, which LoadLevel has sized
+// with MazeCols/MazeRows and filled with wall. Working memory comes from the arena
+// above a mark and is rewound before returning. Returns the player spawn.
+GridPos GenerateMaze(TileGrid& grid, LevelArena& arena, const MazeSettings& settings);
+
+//  QUESTION BANK 
+extern const Question questionBank[];
+extern const int QUESTION_COUNT;
+
+//  Helper: Shuffle Questions & Rig the Deck 
+void ShuffleQuestions();
+
+//  Wall Mesh 
+const float WALL_RADIUS = 6.0f;    // DrawRectangleRounded(0.2f) on a 60 px tile
+const int WALL_CORNER_SEGMENTS = 4;
+const int MESH_MAX_VERTICES = 65535;
+
+// GPU side of a level: uploaded by the render thread when a snapshot first shows the
+// level, released before the level is retired. Only the wall meshes are touched,
+// and the simulation never does after LoadLevel.
+void UploadLevelGpu(Level& lvl);
+
+void UnloadLevelGpu(Level& lvl);
+
+//  Patrol Routes 
+// Every guard gets a loop near its spawn, compiled at load time into a table of
+// each tile's position on the route plus a distance field to it. Walking a patrol
+// is then one read per step, and a guard that left its route to chase or search
+// finds the way back down the field. Loops keep clear of doors; the fields go
+// through them and are repaired when one opens or closes.
+const int GUARD_COUNT = 6;
+const int MAX_ROUTE_LENGTH = 64;
+const int PATROL_REACH_MIN = 5;    // How far (in steps) the far end of a loop is from its start
+const int PATROL_REACH_MAX = 12;
+const unsigned char ROUTE_OFF = 255; // Not on the loop
+
+// Loops for every guard plus their lookup tables and distance fields. Scratch comes
+// from above a mark and is given back; the tables stay in the level arena.
+void CompilePatrolRoutes(Level& lvl, const int* spawnTiles, int guards, std::mt19937& gen);
+
+//  Initialization 
+// Upper bound on what LoadLevel takes from the arena for a map of this size:
+// grid, distance and BFS lists, the wall pass scratch, the mesh chunk list and
+// the patrol tables with their search scratch and distance fields, the door list,
+// the noise cells and the fog image. The maze generator's scratch (about 2.3 bytes
+// per tile) is rewound before any of the rest is taken, so it fits inside them.
+size_t LevelArenaBytes(int cols, int rows);
+
+// Builds a complete level from a recipe. Touches no globals, so it is safe on the worker thread.
+void LoadLevel(Level& out, const LevelRecipe& recipe);
+
+//  Level Pipeline 
+// Builds the next level on a worker thread while the current one is played.
+// The finished level is published through one atomic pointer, and retired levels
+// are handed back to be rebuilt in place, so after the first few runs no level
+// memory is allocated or freed at all.
+class LevelPipeline {
+public:
+    void Start() {
+        worker = std::thread([this] { Run(); });
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            quit = true;
+        }
+        wake.notify_one();
+        if (worker.joinable()) worker.join();
+        delete ready.exchange(nullptr);
+        for (Level* spareLevel : spare) delete spareLevel;
+        spare.clear();
+    }
+
+    void Request(const LevelRecipe& recipe) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            job = recipe;
+            hasJob = true;
+        }
+        wake.notify_one();
+    }
+
+    // Finished level, or nullptr while it is still being built. Never blocks.
+    Level* Take() { return ready.exchange(nullptr); }
+
+    bool HasLevel() const { return ready.load() != nullptr; }
+
+    // Headless checks only: blocks while a requested build is still running
+    void WaitUntilBuilt() {
+        std::unique_lock<std::mutex> lock(mtx);
+        done.wait(lock, [this] { return !hasJob && !building; });
+    }
+
+    void Retire(Level* old) {
+        if (!old) return;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            retired.push_back(old);
+        }
+        wake.notify_one();
+    }
+
+private:
+    void Run();
+
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::condition_variable done;
+    bool quit = false;
+    bool hasJob = false;
+    bool building = false;
+    LevelRecipe job;
+    vector<Level*> retired;
+    vector<Level*> spare; // Cleared levels waiting to be rebuilt; only touched under the lock
+    std::atomic<Level*> ready{nullptr};
+};
+
+extern LevelPipeline levelPipeline;
+
+// Recipe for the next run; procedural mode gets a fresh maze every time
+LevelRecipe NextLevelRecipe();
@@ -0,0 +1,231 @@
+// Level memory: the bump arena a level lives in, the arrays carved out of it, the
+// byte streams snapshots are written to and fixed-capacity pools.
+#pragma once
+
+#include "common.h"
+
+//  Level Memory 
+// Fixed-size array carved out of a LevelArena. Behaves like a vector that cannot grow
+// past the capacity it was given; the arena owns the storage.
+template <typename T>
+struct ArenaArray {
+    T* data = nullptr;
+    size_t count = 0;
+    size_t capacity = 0;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    void clear() { count = 0; }
+    T& operator[](size_t i) { return data[i]; }
+    const T& operator[](size_t i) const { return data[i]; }
+    T& back() { return data[count - 1]; }
+    const T& back() const { return data[count - 1]; }
+    T* begin() { return data; }
+    T* end() { return data + count; }
+    const T* begin() const { return data; }
+    const T* end() const { return data + count; }
+
+    void push_back(const T& v) {
+        if (count == capacity) {
+            fprintf(stderr, "ArenaArray overflow (capacity %zu)\n", capacity);
+            abort();
+        }
+        data[count++] = v;
+    }
+};
+
+// One bump-allocated block holding everything a level owns. Levels are recycled,
+// so once the block is big enough for the map size it is never freed or reallocated;
+// starting a new level just moves the pointer back to the start.
+class LevelArena {
+public:
+    LevelArena() = default;
+    LevelArena(const LevelArena&) = delete;
+    LevelArena& operator=(const LevelArena&) = delete;
+    ~LevelArena() { free(base); }
+
+    // Only valid on an empty arena; a big enough block is kept as it is
+    void Reserve(size_t bytes) {
+        used = 0;
+        if (bytes <= capacity) return;
+        free(base);
+        base = (unsigned char*)malloc(bytes);
+        capacity = base ? bytes : 0;
+        if (!base) {
+            fprintf(stderr, "LevelArena: out of memory (%zu bytes)\n", bytes);
+            abort();
+        }
+    }
+
+    template <typename T>
+    T* Alloc(size_t n) {
+        size_t start = (used + alignof(T) - 1) & ~(alignof(T) - 1);
+        if (start + n * sizeof(T) > capacity) {
+            fprintf(stderr, "LevelArena exhausted (%zu of %zu bytes used)\n", used, capacity);
+            abort();
+        }
+        used = start + n * sizeof(T);
+        return (T*)(base + start);
+    }
+
+    template <typename T>
+    ArenaArray<T> Array(size_t cap) {
+        ArenaArray<T> a;
+        a.data = Alloc<T>(cap);
+        a.capacity = cap;
+        return a;
+    }
+
+    // Scratch space: allocate above a mark, then rewind to drop it
+    size_t Mark() const { return used; }
+    void Rewind(size_t mark) { used = mark; }
+    void Reset() { used = 0; }
+    size_t Used() const { return used; }
+    size_t Capacity() const { return capacity; }
+
+private:
+    unsigned char* base = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+};
+
+// Flat binary output/input for snapshots; the writer aborts rather than overrun
+struct ByteWriter {
+    unsigned char* data;
+    size_t capacity;
+    size_t size = 0;
+
+    void Bytes(const void* src, size_t n) {
+        if (size + n > capacity) {
+            fprintf(stderr, "ByteWriter overflow (%zu of %zu bytes)\n", size + n, capacity);
+            abort();
+        }
+        if (n) memcpy(data + size, src, n);
+        size += n;
+    }
+    template <typename T>
+    void Put(const T& v) { Bytes(&v, sizeof(T)); }
+};
+
+struct ByteReader {
+    const unsigned char* data;
+    size_t size;
+    size_t pos = 0;
+
+    void Bytes(void* dst, size_t n) {
+        if (n) memcpy(dst, data + pos, n);
+        pos += n;
+    }
+    template <typename T>
+    T Get() {
+        T v;
+        Bytes(&v, sizeof(T));
+        return v;
+    }
+};
+
+// Refers to a pooled entity. The generation goes up every time a slot is freed,
+// so a handle kept across ticks fails to resolve once its entity is gone instead of
+// silently pointing at whatever took the slot next.
+struct EntityHandle {
+    uint16_t index;
+    uint16_t generation;
+};
+
+const EntityHandle NO_ENTITY = { 0xFFFF, 0 };
+
+// Fixed-capacity pool. Live items stay packed at the front for iteration, removal
+// swaps the last item into the hole, and handles go through a slot table so they
+// survive that move.
+template <typename T, int CAPACITY>
+class Pool {
+public:
+    Pool() {
+        for (int i = 0; i < CAPACITY; i++) {
+            generation[i] = 0;
+            slotToDense[i] = FREE;
+            freeSlots[i] = (uint16_t)(CAPACITY - 1 - i);
+        }
+        freeCount = CAPACITY;
+    }
+
+    // NO_ENTITY if the pool is full
+    EntityHandle Add(const T& item) {
+        if (count == CAPACITY) return NO_ENTITY;
+        uint16_t slot = freeSlots[--freeCount];
+        items[count] = item;
+        denseToSlot[count] = slot;
+        slotToDense[slot] = (uint16_t)count;
+        count++;
+        return { slot, generation[slot] };
+    }
+
+    T* Get(EntityHandle h) {
+        if (h.index >= CAPACITY || slotToDense[h.index] == FREE || generation[h.index] != h.generation) return nullptr;
+        return &items[slotToDense[h.index]];
+    }
+
+    bool Remove(EntityHandle h) {
+        if (!Get(h)) return false;
+        RemoveAt(slotToDense[h.index]);
+        return true;
+    }
+
+    // Removes by position in iteration order (the item at i is replaced by the last one)
+    void RemoveAt(int i) {
+        uint16_t slot = denseToSlot[i];
+        int last = count - 1;
+        items[i] = items[last];
+        denseToSlot[i] = denseToSlot[last];
+        slotToDense[denseToSlot[i]] = (uint16_t)i;
+        slotToDense[slot] = FREE;
+        generation[slot]++;
+        freeSlots[freeCount++] = slot;
+        count--;
+    }
+
+    void Clear() {
+        while (count > 0) RemoveAt(count - 1);
+    }
+
+    // Live items, their slots and every generation; the slot table is rebuilt on load
+    void Save(ByteWriter& w) const {
+        w.Put(count);
+        w.Put(freeCount);
+        w.Bytes(items, count * sizeof(T));
+        w.Bytes(denseToSlot, count * sizeof(uint16_t));
+        w.Bytes(generation, sizeof(generation));
+        w.Bytes(freeSlots, freeCount * sizeof(uint16_t));
+    }
+
+    void Load(ByteReader& r) {
+        count = r.Get<int>();
+        freeCount = r.Get<int>();
+        r.Bytes(items, count * sizeof(T));
+        r.Bytes(denseToSlot, count * sizeof(uint16_t));
+        r.Bytes(generation, sizeof(generation));
+        r.Bytes(freeSlots, freeCount * sizeof(uint16_t));
+        for (int i = 0; i < CAPACITY; i++) slotToDense[i] = FREE;
+        for (int i = 0; i < count; i++) slotToDense[denseToSlot[i]] = (uint16_t)i;
+    }
+
+    EntityHandle HandleAt(int i) const { return { denseToSlot[i], generation[denseToSlot[i]] }; }
+    int Count() const { return count; }
+    bool Empty() const { return count == 0; }
+    T& operator[](int i) { return items[i]; }
+    const T& operator[](int i) const { return items[i]; }
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+
+private:
+    static const uint16_t FREE = 0xFFFF;
+    T items[CAPACITY];
+    uint16_t denseToSlot[CAPACITY];
+    uint16_t slotToDense[CAPACITY];
+    uint16_t generation[CAPACITY];
+    uint16_t freeSlots[CAPACITY];
+    int freeCount = 0;
+    int count = 0;
+};
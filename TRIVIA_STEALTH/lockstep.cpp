@@ -0,0 +1,69 @@
+#include "lockstep.h"
+
+//  Lockstep Co-op 
+uint16_t PackInput(const PlayerInput& in) {
+    uint16_t bits = (uint16_t)(in.up | in.down << 1 | in.left << 2 | in.right << 3 |
+                               in.sprint << 4 | in.confirm << 5 | in.help << 6 | in.back << 7);
+    bits |= (uint16_t)(((in.quizChoice + 1) & 3) << 8);
+    bits |= (uint16_t)(((in.pressedDir + 1) & 7) << 10);
+    bits |= (uint16_t)(in.use << 13);
+    return bits;
+}
+
+PlayerInput UnpackInput(uint16_t bits, double time) {
+    PlayerInput in = {};
+    in.up = bits & 1;
+    in.down = bits & 2;
+    in.left = bits & 4;
+    in.right = bits & 8;
+    in.sprint = bits & 16;
+    in.confirm = bits & 32;
+    in.help = bits & 64;
+    in.back = bits & 128;
+    in.quizChoice = ((bits >> 8) & 3) - 1;
+    in.pressedDir = ((bits >> 10) & 7) - 1;
+    in.use = bits & (1 << 13);
+    in.pressedAt = time;
+    in.time = time;
+    return in;
+}
+
+uint32_t HashGameState() {
+    static unsigned char buffer[SNAPSHOT_MAX_BYTES];
+    ByteWriter w = { buffer, sizeof(buffer) };
+    SaveGameState(w);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < w.size; i++) hash = (hash ^ buffer[i]) * 16777619u;
+    return hash;
+}
+
+// Non-blocking UDP between two ports on 127.0.0.1
+#if defined(__unix__)
+#else
+#endif
+
+Lockstep lockstep;
+
+bool LockstepCanTick() {
+    return currentState != MENU || levelPipeline.HasLevel();
+}
+
+void StepLockstep(double now) {
+    lockstep.Receive(now);
+    if (lockstep.Failed()) {
+        lockstep.Send(); // A partner with another delay still learns why nothing happens
+        return;
+    }
+    if (lockstep.CanSchedule()) lockstep.Schedule(inputBuffer.Consume(now), now);
+    lockstep.Send();
+
+    int steps = 0;
+    while (lockstep.Ready() && LockstepCanTick() && steps++ < 2) {
+        PlayerInput inputs[MAX_PLAYERS];
+        lockstep.Next(inputs);
+        UpdateGame(inputs, LOCKSTEP_DT);
+        lockstep.Confirm(HashGameState());
+        if (statePublisher.Active()) statePublisher.Publish();
+    }
+    if (steps == 0) lockstep.stalls++;
+}
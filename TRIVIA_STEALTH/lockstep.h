@@ -0,0 +1,306 @@
+// Lockstep co-op over UDP: two windows each simulate the same ticks from both
+// players' inputs.
+#pragma once
+
+#include "game.h"
+#if defined(__unix__)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+//  Lockstep Co-op 
+// Two windows, one game: each peer sends its inputs over UDP and a tick is only
+// simulated once both inputs for it are in. Local inputs are scheduled `delay`
+// ticks ahead so the peer's usually arrive before they are needed. The rules run on
+// a fixed step and the only randomness is the seeded rng, so both peers compute the
+// same states; a hash of every tick is exchanged to catch it if they ever do not.
+// Both peers must use the same input delay, so every packet carries it, and a
+// partner that goes quiet ends the session rather than stalling it for ever.
+const float LOCKSTEP_DT = 1.0f / 60.0f;
+const int LOCKSTEP_PORT = 47600; // Seat 0 listens here, seat 1 on the next port
+const double LOCKSTEP_TIMEOUT = 5.0; // Seconds of silence from a partner already heard
+
+// Two bytes per tick: held keys, menu keys, quiz answer, the newest arrow press and E
+uint16_t PackInput(const PlayerInput& in);
+
+// Times come from the tick number, not the clock, so both peers see the same input
+PlayerInput UnpackInput(uint16_t bits, double time);
+
+// FNV-1a over the snapshot bytes
+uint32_t HashGameState();
+
+// Non-blocking UDP between two ports on 127.0.0.1
+#if defined(__unix__)
+struct UdpSocket {
+    int fd = -1;
+    sockaddr_in peer = {};
+
+    bool Open(int localPort, int peerPort) {
+        fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) return false;
+        sockaddr_in local = {};
+        local.sin_family = AF_INET;
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        local.sin_port = htons((uint16_t)localPort);
+        if (bind(fd, (const sockaddr*)&local, sizeof(local)) < 0) {
+            Close();
+            return false;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        peer = local;
+        peer.sin_port = htons((uint16_t)peerPort);
+        return true;
+    }
+
+    void Close() {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+
+    void Send(const void* data, size_t size) {
+        sendto(fd, data, size, 0, (const sockaddr*)&peer, sizeof(peer));
+    }
+
+    // Bytes read, or -1 when nothing is waiting
+    int Receive(void* data, size_t capacity) {
+        return (int)recv(fd, data, capacity, 0);
+    }
+
+    void Wait(double seconds) {
+        pollfd p = { fd, POLLIN, 0 };
+        poll(&p, 1, (int)(seconds * 1000.0));
+    }
+};
+#else
+struct UdpSocket {
+    int fd = -1;
+    bool Open(int, int) { return false; } // Co-op needs BSD sockets
+    void Close() {}
+    void Send(const void*, size_t) {}
+    int Receive(void*, size_t) { return -1; }
+    void Wait(double) {}
+};
+#endif
+
+class Lockstep {
+public:
+    bool Open(int localSeat, int port, int delayTicks) {
+        seat = localSeat;
+        delay = std::clamp(delayTicks, 1, WINDOW / 4);
+        if (!socket.Open(port + seat, port + 1 - seat)) return false;
+
+        // The first `delay` ticks have no input from anyone
+        scheduled = remoteUpTo = peerAck = (uint32_t)delay;
+        executed = 0;
+        heard = false;
+        failure[0] = '\0';
+        return true;
+    }
+
+    void Close() { socket.Close(); }
+    bool Active() const { return socket.fd >= 0; }
+
+    // Set once by the simulating thread; no more ticks run after it
+    bool Failed() const { return failure[0] != '\0'; }
+    const char* Failure() const { return failure; }
+
+    // Room for another local input without running more than `delay` ticks ahead
+    bool CanSchedule() const { return scheduled < executed + delay; }
+
+    void Schedule(const PlayerInput& in, double now) {
+        scheduled++;
+        local[scheduled % WINDOW] = PackInput(in);
+        scheduledAt[scheduled % WINDOW] = now;
+    }
+
+    bool Ready() const { return remoteUpTo > executed && scheduled > executed; }
+
+    // Inputs for the next tick, by seat
+    void Next(PlayerInput inputs[MAX_PLAYERS]) {
+        executed++;
+        double time = executed * (double)LOCKSTEP_DT;
+        inputs[seat] = UnpackInput(local[executed % WINDOW], time);
+        inputs[1 - seat] = UnpackInput(remote[executed % WINDOW], time);
+    }
+
+    // Hash of the state after the tick just simulated
+    void Confirm(uint32_t hash) {
+        localHash[executed % WINDOW] = hash;
+        if (pendingHashTick == executed) CheckHash(pendingHashTick, pendingHash);
+    }
+
+    // Every unacknowledged local input goes out again, so a lost packet costs nothing
+    // unless the next one is lost too
+    void Send() {
+        unsigned char packet[MAX_PACKET];
+        ByteWriter w = { packet, sizeof(packet) };
+        uint32_t first = peerAck + 1;
+        uint8_t count = (uint8_t)min<uint32_t>(scheduled - peerAck, MAX_INPUTS_PER_PACKET);
+        w.Put((uint8_t)seat);
+        w.Put((uint8_t)delay);
+        w.Put(remoteUpTo);
+        w.Put(executed);
+        w.Put(executed > 0 ? localHash[executed % WINDOW] : 0u);
+        w.Put(first);
+        w.Put(count);
+        for (uint32_t t = first; t < first + count; t++) w.Put(local[t % WINDOW]);
+
+        packetsSent++;
+        bytesSent += w.size;
+        if (dropRate > 0 && dropRng.Chance(dropRate)) return; // Simulated loss (check only)
+        socket.Send(packet, w.size);
+    }
+
+    void Receive(double now) {
+        if (Failed()) return;
+        unsigned char packet[MAX_PACKET];
+        int size;
+        while ((size = socket.Receive(packet, sizeof(packet))) > 0) {
+            packetsReceived++;
+            bytesReceived += size;
+            if ((size_t)size < HEADER_BYTES) continue;
+            ByteReader r = { packet, (size_t)size };
+            if (r.Get<uint8_t>() == seat) continue; // Our own packet; both seats configured the same
+            int peerDelay = r.Get<uint8_t>();
+            if (peerDelay != delay) {
+                // Ticks 1..delay are empty on each side, so the inputs would never line up
+                snprintf(failure, sizeof(failure), "input delay is %d here but %d on the partner", delay, peerDelay);
+                return;
+            }
+            heard = true;
+            lastHeard = now;
+            uint32_t ack = r.Get<uint32_t>();
+            uint32_t hashTick = r.Get<uint32_t>();
+            uint32_t hash = r.Get<uint32_t>();
+            uint32_t first = r.Get<uint32_t>();
+            uint8_t count = r.Get<uint8_t>();
+            if ((size_t)size != HEADER_BYTES + count * sizeof(uint16_t)) continue;
+
+            // Round trip: from scheduling an input to hearing that the peer has it
+            for (uint32_t t = peerAck + 1; t <= ack && t <= scheduled; t++) RecordRtt(now - scheduledAt[t % WINDOW]);
+            peerAck = max(peerAck, min(ack, scheduled));
+
+            // Inputs always start at or before the first one missing here
+            if (first <= remoteUpTo + 1) {
+                for (uint32_t t = first; t < first + count; t++) {
+                    uint16_t bits = r.Get<uint16_t>();
+                    if (t <= remoteUpTo) continue;
+                    if (t - executed >= WINDOW) break;
+                    remote[t % WINDOW] = bits;
+                    remoteUpTo = t;
+                }
+            }
+
+            if (hashTick == 0 || hashTick <= lastHashChecked) continue;
+            if (hashTick <= executed) {
+                if (executed - hashTick < WINDOW) CheckHash(hashTick, hash);
+            } else {
+                pendingHashTick = hashTick;
+                pendingHash = hash;
+            }
+        }
+        if (heard && now - lastHeard > LOCKSTEP_TIMEOUT) {
+            snprintf(failure, sizeof(failure), "partner stopped responding");
+        }
+        // The HUD only needs a rough figure, so the sort runs once a second at most
+        if (rttRecorded != medianSamples && now - medianAt >= 1.0) {
+            rttMedian = RttPercentile(0.5f);
+            medianSamples = rttRecorded;
+            medianAt = now;
+        }
+    }
+
+    float RttMedian() const { return rttMedian; } // As of the last refresh in Receive
+
+    void Wait(double seconds) { socket.Wait(seconds); }
+
+    float RttPercentile(float p) const {
+        int n = (int)min<long long>(rttRecorded, MAX_RTT_SAMPLES);
+        if (n == 0) return 0.0f;
+        static float sorted[MAX_RTT_SAMPLES];
+        memcpy(sorted, rtt, n * sizeof(float));
+        int k = min(n - 1, (int)(p * n));
+        std::nth_element(sorted, sorted + k, sorted + n);
+        return sorted[k];
+    }
+
+    void PrintStats(double seconds) const {
+        double ticks = max<double>(1.0, executed);
+        printf("Co-op seat %d, input delay %d ticks: %u ticks in %.1f s, %lld stalled frames\n",
+               seat + 1, delay, executed, seconds, stalls);
+        printf("  sent %lld packets, %lld bytes (%.1f B/tick, %.1f kbit/s); received %lld packets, %lld bytes\n",
+               packetsSent, bytesSent, bytesSent / ticks, seconds > 0 ? bytesSent * 8.0 / seconds / 1000.0 : 0.0,
+               packetsReceived, bytesReceived);
+        printf("  input round trip: p50 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+               RttPercentile(0.5f) * 1000.0f, RttPercentile(0.99f) * 1000.0f, RttPercentile(1.0f) * 1000.0f);
+        printf("  state hashes: %lld compared, %lld desyncs", hashesChecked, desyncs);
+        if (desyncs) printf(" (first at tick %u)", firstDesync);
+        printf("\n");
+    }
+
+    int seat = 0;
+    int delay = 3;
+    uint32_t executed = 0;
+    uint32_t lastHashChecked = 0;
+    long long stalls = 0;          // Frames that wanted a tick but lacked the peer's input
+    long long packetsSent = 0, bytesSent = 0;
+    long long packetsReceived = 0, bytesReceived = 0;
+    long long hashesChecked = 0, desyncs = 0;
+    uint32_t firstDesync = 0;
+    float dropRate = 0.0f;         // Share of outgoing packets thrown away, to exercise resends
+    MazeRng dropRng{ 99 };
+
+private:
+    static const int WINDOW = 128; // Ticks of inputs and hashes kept; far more than ever in flight
+    static const int MAX_INPUTS_PER_PACKET = 64;
+    static const size_t HEADER_BYTES = 1 + 1 + 4 * 4 + 1;
+    static const size_t MAX_PACKET = HEADER_BYTES + MAX_INPUTS_PER_PACKET * sizeof(uint16_t);
+    static const int MAX_RTT_SAMPLES = 4096;
+
+    void CheckHash(uint32_t tick, uint32_t hash) {
+        lastHashChecked = tick;
+        hashesChecked++;
+        if (localHash[tick % WINDOW] == hash) return;
+        if (desyncs++ == 0) {
+            firstDesync = tick;
+            printf("Co-op: peers desynced at tick %u\n", tick);
+        }
+    }
+
+    void RecordRtt(double seconds) {
+        rtt[rttRecorded % MAX_RTT_SAMPLES] = (float)seconds;
+        rttRecorded++;
+    }
+
+    UdpSocket socket;
+    uint16_t local[WINDOW] = {};
+    uint16_t remote[WINDOW] = {};
+    double scheduledAt[WINDOW] = {};
+    uint32_t localHash[WINDOW] = {};
+    uint32_t scheduled = 0;  // Newest local tick with an input
+    uint32_t remoteUpTo = 0; // Every peer input up to here has arrived
+    uint32_t peerAck = 0;    // The peer has every local input up to here
+    uint32_t pendingHashTick = 0;
+    uint32_t pendingHash = 0;
+    float rtt[MAX_RTT_SAMPLES];
+    long long rttRecorded = 0;
+    float rttMedian = 0;
+    long long medianSamples = 0; // rttRecorded when rttMedian was worked out
+    double medianAt = -1e9;
+    bool heard = false;      // A packet from the partner has arrived
+    double lastHeard = 0;
+    char failure[64] = {};   // Why the session ended, empty while it runs
+};
+
+extern Lockstep lockstep;
+
+// A tick on the menu may start a run, and a peer still building the level would
+// start it later than the other; so such ticks wait until the level is built here
+bool LockstepCanTick();
+
+// One frame of co-op: trade inputs, then simulate whatever ticks both peers have
+// inputs for. Catches up by at most a couple of ticks per frame after a stall.
+void StepLockstep(double now);
@@ -0,0 +1,551 @@
+#include "render.h"
+
+//  Render Stats 
+void DrawRenderStatsOverlay(double drawMs, long long framesDrawn, long long framesSkipped) {
+    if (!renderStats.overlay) return;
+
+    Rectangle panel = { 10, SCREEN_HEIGHT - 190.0f, 430, 180 };
+    DrawRectangleRec(panel, Fade(BLACK, 0.75f));
+    DrawText(TextFormat("RENDER  %.2f ms draw  %lld drawn / %lld skipped  scale %.2f %s", drawMs, framesDrawn,
+                        framesSkipped, governor.Scale(), governor.Quality().name),
+             panel.x + 10, panel.y + 8, 10, YELLOW);
+    DrawText("phase       prims   verts  switch  flush", panel.x + 10, panel.y + 26, 10, LIGHTGRAY);
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        const PhaseStats& p = renderStats.phases[i];
+        DrawText(TextFormat("%-10s %6d %7d %7d %6d", PHASE_NAMES[i], p.primitives, p.vertices, p.switches, p.flushes),
+                 panel.x + 10, panel.y + 42 + i * 14, 10, WHITE);
+    }
+    DrawText("batch breaks (line x count):", panel.x + 10, panel.y + 92, 10, LIGHTGRAY);
+    for (int i = 0; i < renderStats.breakCount && i < 12; i++) {
+        const BatchBreak& b = renderStats.breaks[i];
+        DrawText(TextFormat("%c%d x%d", PHASE_NAMES[b.phase][0], b.line, b.count),
+                 panel.x + 10 + (i % 4) * 100, panel.y + 108 + (i / 4) * 14, 10, SKYBLUE);
+    }
+}
+
+//  Text Layout 
+// Advance widths for one font at one size, so wrapping never re-measures glyphs
+struct GlyphMetrics {
+    Font font;
+    float fontSize;
+    float spacing;
+    float ascii[128];
+    unordered_map<int, float> extended; // Filled on first use for non-ASCII codepoints
+
+    float Advance(int codepoint) {
+        if (codepoint >= 0 && codepoint < 128) return ascii[codepoint];
+        auto it = extended.find(codepoint);
+        if (it != extended.end()) return it->second;
+        return extended[codepoint] = MeasureGlyph(codepoint);
+    }
+
+    float MeasureGlyph(int codepoint) const {
+        int i = GetGlyphIndex(font, codepoint);
+        float adv = font.glyphs[i].advanceX ? (float)font.glyphs[i].advanceX : font.recs[i].width;
+        return adv * fontSize / font.baseSize;
+    }
+};
+
+vector<unique_ptr<GlyphMetrics>> glyphCache;
+
+GlyphMetrics& GetGlyphMetrics(Font font, float fontSize) {
+    for (auto& m : glyphCache) {
+        if (m->font.texture.id == font.texture.id && m->fontSize == fontSize) return *m;
+    }
+
+    auto m = make_unique<GlyphMetrics>();
+    m->font = font;
+    m->fontSize = fontSize;
+    // Same spacing rule DrawText uses for the default font
+    m->spacing = (float)(max((int)fontSize, 10) / 10);
+    for (int c = 0; c < 128; c++) m->ascii[c] = m->MeasureGlyph(c < 32 ? '?' : c);
+    glyphCache.push_back(std::move(m));
+    return *glyphCache.back();
+}
+
+// Decodes one UTF-8 codepoint; malformed bytes come back as '?' and are consumed singly
+int DecodeUtf8(const char* s, int available, int& bytes) {
+    unsigned char c = (unsigned char)s[0];
+    int need = (c < 0x80) ? 0 : (c >> 5) == 0x6 ? 1 : (c >> 4) == 0xE ? 2 : (c >> 3) == 0x1E ? 3 : -1;
+    bytes = 1;
+    if (need == 0) return c;
+    if (need < 0 || need >= available) return '?';
+
+    int cp = c & (0x3F >> need);
+    for (int i = 1; i <= need; i++) {
+        unsigned char cc = (unsigned char)s[i];
+        if ((cc & 0xC0) != 0x80) return '?';
+        cp = (cp << 6) | (cc & 0x3F);
+    }
+    bytes = need + 1;
+    return cp;
+}
+
+float MeasureSpan(GlyphMetrics& m, const char* text, int start, int end) {
+    float w = 0;
+    int glyphs = 0;
+    for (int i = start; i < end;) {
+        int bytes;
+        int cp = DecodeUtf8(text + i, end - i, bytes);
+        w += m.Advance(cp) + (glyphs++ ? m.spacing : 0);
+        i += bytes;
+    }
+    return w;
+}
+
+// Word-wraps text to maxWidth (0 = no wrapping). Breaks at spaces and explicit
+// newlines; a single word wider than the line is split between glyphs.
+TextLayout LayoutText(std::string_view source, float fontSize, float maxWidth) {
+    Font font = GetFontDefault();
+    GlyphMetrics& m = GetGlyphMetrics(font, fontSize);
+    const char* text = source.data();
+    int len = (int)source.size();
+
+    vector<TextLine> spans;
+    int lineStart = 0;
+    float lineW = 0;
+    int glyphs = 0;
+    int breakAt = -1;
+    float widthAtBreak = 0;
+
+    for (int i = 0; i < len;) {
+        int bytes;
+        int cp = DecodeUtf8(text + i, len - i, bytes);
+
+        if (cp == '\n') {
+            spans.push_back({lineStart, i - lineStart, lineW});
+            i += bytes;
+            lineStart = i;
+            lineW = 0;
+            glyphs = 0;
+            breakAt = -1;
+            continue;
+        }
+
+        float adv = m.Advance(cp) + (glyphs ? m.spacing : 0);
+        if (maxWidth > 0 && glyphs > 0 && cp != ' ' && lineW + adv > maxWidth) {
+            if (breakAt >= 0) {
+                // Wrap at the last space and carry the partial word to the next line
+                spans.push_back({lineStart, breakAt - lineStart, widthAtBreak});
+                lineStart = breakAt + 1;
+                lineW = MeasureSpan(m, text, lineStart, i);
+                glyphs = (i > lineStart);
+            } else {
+                spans.push_back({lineStart, i - lineStart, lineW});
+                lineStart = i;
+                lineW = 0;
+                glyphs = 0;
+            }
+            breakAt = -1;
+            continue;
+        }
+
+        if (cp == ' ') {
+            breakAt = i;
+            widthAtBreak = lineW;
+        }
+        lineW += adv;
+        glyphs++;
+        i += bytes;
+    }
+    spans.push_back({lineStart, len - lineStart, lineW});
+
+    TextLayout layout;
+    layout.fontSize = fontSize;
+    layout.spacing = m.spacing;
+    layout.lineHeight = fontSize * 1.4f;
+    for (const TextLine& span : spans) {
+        layout.lines.push_back({(int)layout.text.size(), span.length, span.width});
+        layout.text.append(text + span.start, span.length);
+        layout.text.push_back('\0');
+        layout.width = max(layout.width, span.width);
+    }
+    return layout;
+}
+
+// Replays precomputed spans; centerWidth > 0 centres each line inside that width
+void DrawTextLayout(DrawLayer layer, const TextLayout& layout, float x, float y, Color color, float centerWidth = 0) {
+    for (size_t i = 0; i < layout.lines.size(); i++) {
+        const TextLine& line = layout.lines[i];
+        float lx = (centerWidth > 0) ? x + (centerWidth - line.width) / 2.0f : x;
+        drawList.TextEx(layer, layout.text.c_str() + line.start, {lx, y + i * layout.lineHeight}, layout.fontSize, layout.spacing, color);
+    }
+}
+
+// Wrapped question and numbered options, shaped the first time the question is shown
+struct QuestionLayout {
+    bool ready = false;
+    TextLayout text;
+    TextLayout options[3];
+    float optionY[3];
+    float promptY;
+    float boxHeight;
+};
+
+vector<QuestionLayout> questionLayouts;
+
+void PrepareQuestionLayout(int id) {
+    QuestionLayout& q = questionLayouts[id];
+    if (q.ready) return;
+
+    const Question& src = questionBank[id];
+    q.text = LayoutText(src.text, 20, QUIZ_TEXT_WIDTH);
+
+    // Same spacing as the fixed layout (options at 180/230/280, prompt at 350),
+    // pushed down only when long text needs more room
+    float y = max(180.0f, 100.0f + q.text.Height() + 20.0f);
+    for (int i = 0; i < 3; i++) {
+        string numbered = to_string(i + 1) + ". ";
+        numbered += src.options[i];
+        q.options[i] = LayoutText(numbered, 20, QUIZ_TEXT_WIDTH);
+        q.optionY[i] = y;
+        y += max(50.0f, q.options[i].Height() + 22.0f);
+    }
+    q.promptY = y + 20.0f;
+    q.boxHeight = q.promptY + 50.0f;
+    q.ready = true;
+}
+
+void PrepareQuestionLayouts() {
+    questionLayouts.resize(QUESTION_COUNT);
+    for (int i = 0; i < QUESTION_COUNT; i++) PrepareQuestionLayout(i);
+}
+
+//  Particles 
+ParticleSystem particles;
+
+void UpdateParticles(float dt) {
+    float share = governor.Quality().particleShare;
+    EffectEvent e;
+    while (effects.Pop(e)) {
+        Vector2 at = { e.x * TILE_SIZE + TILE_SIZE / 2.0f, e.y * TILE_SIZE + TILE_SIZE / 2.0f + UI_HEIGHT };
+        switch (e.kind) {
+            case FX_DIAMOND: particles.Burst(at, (int)(60 * share), COL_DIAMOND, 220.0f, 0.8f, 5.0f); break;
+            case FX_NUGGET: particles.Burst(at, (int)(40 * share), COL_NUGGET, 160.0f, 0.7f, 4.0f); break;
+            case FX_GHOST: particles.Burst(at, (int)(120 * share), { 100, 255, 218, 255 }, 260.0f, 1.2f, 4.0f); break;
+            case FX_FREEZE: particles.Burst(at, (int)(90 * share), SKYBLUE, 120.0f, 1.5f, 6.0f); break;
+        }
+    }
+    particles.Update(dt);
+}
+
+//  Animation Clock 
+AnimClock animClock;
+
+// . Drawing Functions .
+
+// Render thread state of the GPU resources; see SyncRenderResources
+Level* gpuLevel = nullptr;
+uint32_t gpuLevelSerial = 0;
+long long fogTick = -1;
+Texture2D fogTexture = {};
+Material meshMaterial = {}; // Wall meshes are drawn with raylib's default material
+
+void SyncRenderResources(const RenderSnapshot& snap) {
+    bool gpu = IsWindowReady(); // Headless checks only do the handoff
+    if (gpu && !meshMaterial.maps) meshMaterial = LoadMaterialDefault();
+    if (snap.levelSerial != gpuLevelSerial) {
+        if (gpu && gpuLevel) UnloadLevelGpu(*gpuLevel);
+        if (gpu && snap.level) UploadLevelGpu(*snap.level);
+        gpuLevel = snap.level;
+        gpuLevelSerial = snap.levelSerial;
+        fogTick = -1;
+        levelHandoff.drawn.store(snap.levelSerial, std::memory_order_release);
+    }
+    if (!gpu || snap.viewCols == 0 || snap.tick == fogTick) return;
+
+    if (fogTexture.width != snap.viewCols || fogTexture.height != snap.viewRows) {
+        if (fogTexture.id) UnloadTexture(fogTexture);
+        Image fogImage = { (void*)snap.fog, snap.viewCols, snap.viewRows, 1, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA };
+        fogTexture = LoadTextureFromImage(fogImage);
+        SetTextureFilter(fogTexture, TEXTURE_FILTER_BILINEAR); // Soft edges from a tile-sized image
+        SetTextureWrap(fogTexture, TEXTURE_WRAP_CLAMP);
+    } else {
+        UpdateTexture(fogTexture, snap.fog);
+    }
+    fogTick = snap.tick;
+}
+
+void UnloadRenderResources() {
+    if (gpuLevel) UnloadLevelGpu(*gpuLevel);
+    gpuLevel = nullptr;
+    if (fogTexture.id) UnloadTexture(fogTexture);
+    fogTexture = {};
+    if (meshMaterial.maps) UnloadMaterial(meshMaterial);
+    meshMaterial = {};
+}
+
+void DrawGameMap(const RenderSnapshot& snap) {
+    // Only the tile window the snapshot carries, which covers the camera view
+    int x0 = snap.viewX;
+    int y0 = snap.viewY;
+    Rectangle view = { x0 * (float)TILE_SIZE, y0 * (float)TILE_SIZE + UI_HEIGHT, snap.viewCols * (float)TILE_SIZE, snap.viewRows * (float)TILE_SIZE };
+
+    drawList.Rect(LAYER_FLOOR, view, BG_COLOR);
+
+    // Walls: the prebuilt static mesh, one draw per visible band (one total on the default map)
+    for (const auto& chunk : snap.level->wallMeshes) {
+        if (!CheckCollisionRecs(chunk.bounds, view)) continue;
+        drawList.Mesh(LAYER_WALLS, chunk.mesh);
+    }
+
+    for (int j = 0; j < snap.viewRows; j++) {
+        for (int i = 0; i < snap.viewCols; i++) {
+            int x = x0 + i;
+            int y = y0 + j;
+            unsigned char tile = snap.tiles[j * snap.viewCols + i];
+            Rectangle rect = { (float)x * TILE_SIZE, (float)y * TILE_SIZE + UI_HEIGHT, (float)TILE_SIZE, (float)TILE_SIZE };
+
+            // Sprint noise still in the air
+            unsigned char heard = snap.noise[j * snap.viewCols + i];
+            if (heard > 0) drawList.Rect(LAYER_TILES, rect, Fade(COL_NUGGET, 0.25f * heard / 255.0f));
+
+            if (tile == TILE_DOOR) {
+                drawList.Rect(LAYER_TILES, rect, COL_DOOR);
+                drawList.RectLines(LAYER_TILES, rect.x, rect.y, rect.width, rect.height, Fade(WHITE, 0.4f));
+            } else if (tile == TILE_DOOR_OPEN) {
+                drawList.RectLines(LAYER_TILES, rect.x + 4, rect.y + 4, rect.width - 8, rect.height - 8, Fade(COL_DOOR, 0.6f));
+            }
+
+            if (tile == TILE_EXIT) {
+                if (snap.diamondsLeft == 0) {
+                    drawList.Rect(LAYER_TILES, rect, Fade(GREEN, 0.3f));
+                    drawList.RectLines(LAYER_TILES, rect.x, rect.y, rect.width, rect.height, Fade(LIME, animClock.exitAlpha));
+                    drawList.Text(LAYER_TILES, "EXIT", x * TILE_SIZE + 10, y * TILE_SIZE + UI_HEIGHT + 15, 10, WHITE);
+                } else {
+                    drawList.Rect(LAYER_TILES, rect, Fade(RED, 0.2f));
+                    drawList.RectLines(LAYER_TILES, rect.x, rect.y, rect.width, rect.height, RED);
+                    drawList.Text(LAYER_TILES, "LOCKED", x * TILE_SIZE + 2, y * TILE_SIZE + UI_HEIGHT + 20, 10, RED);
+                }
+            }
+        }
+    }
+}
+
+// Draw systems: pickups, then the player, then guards on top
+void DrawPickupSystem(const RenderSnapshot& snap) {
+    float offset = TILE_SIZE / 2.0f;
+    const QualitySettings& quality = governor.Quality();
+
+    float scale[MAX_ENTITIES];
+    float spin[MAX_ENTITIES];
+    animClock.PickupBatch(snap.pickupPhases, snap.pickupCount, scale, spin);
+    for (int i = 0; i < snap.pickupCount; i++) {
+        const PickupView& p = snap.pickups[i];
+        Vector2 center = { p.x * TILE_SIZE + offset, p.y * TILE_SIZE + offset + UI_HEIGHT };
+        if (p.kind == PICKUP_DIAMOND) {
+            drawList.Poly(LAYER_PICKUPS, center, 4, 15, spin[i], COL_DIAMOND);
+            if (quality.outlines) drawList.PolyLines(LAYER_PICKUPS, center, 4, 17, spin[i], WHITE);
+        } else {
+            if (quality.glow) drawList.Circle(LAYER_PICKUPS, center, 8 * scale[i], Fade(COL_NUGGET, 0.4f));
+            drawList.Circle(LAYER_PICKUPS, center, 7, COL_NUGGET);
+        }
+    }
+}
+
+void DrawPlayerSystem(const RenderSnapshot& snap) {
+    const QualitySettings& quality = governor.Quality();
+    for (int i = 0; i < snap.thiefCount; i++) {
+        const ThiefView& t = snap.thieves[i];
+        Color pColor = t.player == localPlayer ? COL_PLAYER : COL_PARTNER;
+        if (t.invisible) pColor = COL_INVISIBLE;
+        if (t.frozen) pColor = SKYBLUE;
+
+        Rectangle pRect = {
+            t.x * TILE_SIZE + 6.0f,
+            t.y * TILE_SIZE + 6.0f + UI_HEIGHT,
+            TILE_SIZE - 12.0f,
+            TILE_SIZE - 12.0f
+        };
+
+        if (quality.roundSegments == 0) {
+            drawList.Rect(LAYER_ACTORS, pRect, pColor);
+        } else {
+            if (quality.shadows) drawList.Rounded(LAYER_SHADOWS, {pRect.x + 3, pRect.y + 3, pRect.width, pRect.height}, 0.3f, quality.roundSegments, Fade(BLACK, 0.4f));
+            drawList.Rounded(LAYER_ACTORS, pRect, 0.3f, quality.roundSegments, pColor);
+        }
+        drawList.Circle(LAYER_ACTORS, pRect.x + 12, pRect.y + 12, 4, BLACK);
+        drawList.Circle(LAYER_ACTORS, pRect.x + 28, pRect.y + 12, 4, BLACK);
+    }
+}
+
+void DrawGuardSystem(const RenderSnapshot& snap) {
+    float offset = TILE_SIZE / 2.0f;
+    const QualitySettings& quality = governor.Quality();
+    for (int i = 0; i < snap.guardCount; i++) {
+        const GuardView& g = snap.guards[i];
+        Vector2 center = { g.x * TILE_SIZE + offset, g.y * TILE_SIZE + offset + UI_HEIGHT };
+        Color eColor = g.slow ? COL_ENEMY_SLOW : COL_ENEMY_FAST;
+
+        if (quality.shadows) drawList.Circle(LAYER_SHADOWS, {center.x + 3, center.y + 3}, 18, Fade(BLACK, 0.4f));
+        drawList.Circle(LAYER_ACTORS, center, 18, eColor);
+        if (quality.outlines) drawList.CircleLines(LAYER_ACTORS, center.x, center.y, 18, BLACK);
+        drawList.LineEx(LAYER_ACTORS, {center.x - 8, center.y - 4}, {center.x - 2, center.y + 4}, 3, BLACK);
+        drawList.LineEx(LAYER_ACTORS, {center.x + 8, center.y - 4}, {center.x + 2, center.y + 4}, 3, BLACK);
+        if (g.searching) drawList.Text(LAYER_ACTORS, "?", center.x - 5, center.y - 42, 20, YELLOW);
+    }
+}
+
+void DrawEntities(const RenderSnapshot& snap) {
+    DrawPickupSystem(snap);
+    DrawPlayerSystem(snap);
+    DrawGuardSystem(snap);
+}
+
+// One quad over the tile window; filtering turns the tile steps into soft edges
+void DrawFogOverlay(const RenderSnapshot& snap) {
+    Rectangle dest = { snap.viewX * (float)TILE_SIZE, snap.viewY * (float)TILE_SIZE + UI_HEIGHT,
+                       snap.viewCols * (float)TILE_SIZE, snap.viewRows * (float)TILE_SIZE };
+    drawList.Texture(LAYER_FOG, fogTexture, dest, WHITE);
+}
+
+void DrawWorld(const RenderSnapshot& snap) {
+    drawList.Rect(LAYER_BACKDROP, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, BG_COLOR);
+    DrawGameMap(snap);
+    DrawEntities(snap);
+    particles.Draw();
+    DrawFogOverlay(snap);
+}
+
+void DrawUI(const RenderSnapshot& snap) {
+    if (snap.state == MENU) {
+        // . 1. Background with Gradient .
+        drawList.RectGradientV(LAYER_BACKDROP, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, BG_COLOR, {10, 10, 15, 255});
+
+        // Background Deco (Spinning large diamond)
+        drawList.PolyLines(LAYER_BACKDROP, {SCREEN_WIDTH/2.0f, SCREEN_HEIGHT/2.0f + 50}, 4, 300, animClock.menuSpin[0], Fade(COL_DIAMOND, 0.05f));
+        drawList.PolyLines(LAYER_BACKDROP, {SCREEN_WIDTH/2.0f, SCREEN_HEIGHT/2.0f + 50}, 4, 280, animClock.menuSpin[1], Fade(COL_DIAMOND, 0.05f));
+
+        // . 2. Title with Shadow .
+        // Centred labels are shaped once, not measured every frame
+        static const TextLayout title1 = LayoutText("MAZE RUNNER", 40, 0);
+        static const TextLayout title2 = LayoutText("DIAMOND HEIST", 50, 0);
+
+        DrawTextLayout(LAYER_SCREEN, title1, 4, 124, BLACK, SCREEN_WIDTH);
+        DrawTextLayout(LAYER_SCREEN, title1, 0, 120, LIGHTGRAY, SCREEN_WIDTH);
+        DrawTextLayout(LAYER_SCREEN, title2, 4, 164, BLACK, SCREEN_WIDTH);
+        DrawTextLayout(LAYER_SCREEN, title2, 0, 160, COL_DIAMOND, SCREEN_WIDTH);
+
+        // . 3. Info Panel .
+        Rectangle panel = { SCREEN_WIDTH/2.0f - 220, 260, 440, 240 };
+        drawList.Rounded(LAYER_SCREEN, panel, 0.1f, 10, Fade(COL_UI_PANEL, 0.8f));
+        drawList.RoundedLines(LAYER_SCREEN, panel, 0.1f, 10, Fade(COL_DIAMOND, 0.3f));
+
+        drawList.Text(LAYER_SCREEN, "MISSION OBJECTIVES", panel.x + 110, panel.y + 20, 20, YELLOW);
+        drawList.Rect(LAYER_SCREEN, panel.x + 40, panel.y + 50, 360, 2, Fade(WHITE, 0.2f));
+
+        drawList.Text(LAYER_SCREEN, "- Collect 5 Diamonds to Open Exit", panel.x + 40, panel.y + 70, 20, WHITE);
+        drawList.Text(LAYER_SCREEN, "- Answer Trivia for Speed Boosts", panel.x + 40, panel.y + 110, 20, WHITE);
+        drawList.Text(LAYER_SCREEN, "- Use SHIFT to Sprint (Costs Stamina)", panel.x + 40, panel.y + 150, 20, WHITE);
+        drawList.Text(LAYER_SCREEN, "- Avoid the Guards!", panel.x + 40, panel.y + 190, 20, COL_ENEMY_FAST);
+
+        // . 4. Start Prompt (Pulsing) .
+        Color startColor = Fade(WHITE, 0.5f + (animClock.menuPulse * 0.5f));
+        static const TextLayout startText = LayoutText("PRESS [ENTER] TO START", 30, 0);
+        static const TextLayout loadingText = LayoutText("BUILDING THE MAZE...", 30, 0);
+        DrawTextLayout(LAYER_SCREEN, snap.loading ? loadingText : startText, 0, 560, startColor, SCREEN_WIDTH);
+
+        // . 5. Help Button Look .
+        Rectangle helpRect = { SCREEN_WIDTH/2.0f - 120, 630, 240, 40 };
+        drawList.Rounded(LAYER_SCREEN, helpRect, 0.5f, 6, Fade(SKYBLUE, 0.2f));
+        drawList.RoundedLines(LAYER_SCREEN, helpRect, 0.5f, 6, SKYBLUE);
+        drawList.Text(LAYER_SCREEN, "PRESS [H] FOR TIPS", helpRect.x + 35, helpRect.y + 10, 20, SKYBLUE);
+    }
+    else if (snap.state == HELP) {
+        drawList.RectGradientV(LAYER_BACKDROP, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, {15, 10, 10, 255}, BLACK);
+
+        drawList.Text(LAYER_BACKDROP, "STRUGGLING TO WIN?", 50, 50, 80, Fade(RED, 0.2f));
+        static const TextLayout guideTitle = LayoutText("SURVIVAL GUIDE", 40, 0);
+        DrawTextLayout(LAYER_SCREEN, guideTitle, 0, 100, GOLD, SCREEN_WIDTH);
+
+        int startY = 200;
+        int spacing = 60;
+        int fontSize = 20;
+        int xPos = 100;
+
+        auto DrawTip = [&](int index, const char* text) {
+            drawList.Rect(LAYER_SCREEN, xPos - 20, startY + (index*spacing) + 5, 10, 10, COL_DIAMOND);
+            drawList.Text(LAYER_SCREEN, text, xPos, startY + (index*spacing), fontSize, WHITE);
+        };
+
+        DrawTip(0, "Use [SHIFT] to sprint out of sticky situations.");
+        DrawTip(1, "Answer trivia questions correctly to enter ghost mode for 4 seconds.");
+        DrawTip(2, "Increase distance from enemies to hide.");
+        DrawTip(3, "Don't get cornered in dead ends.");
+        DrawTip(4, "Enemies track you within a specific radius.");
+        DrawTip(5, "Press [E] next to a door to shut it in a guard's face.");
+
+        drawList.Text(LAYER_SCREEN, "PRESS [H] OR [ENTER] TO RETURN", SCREEN_WIDTH/2 - 150, SCREEN_HEIGHT - 100, 20, LIGHTGRAY);
+    }
+    else {
+        // Draw the top bar background for game
+        if (snap.state == PLAYING || snap.state == FROZEN) {
+            drawList.Rect(LAYER_HUD, 0, 0, SCREEN_WIDTH, UI_HEIGHT, COL_UI_PANEL);
+            drawList.Line(LAYER_HUD, 0, UI_HEIGHT, SCREEN_WIDTH, UI_HEIGHT, WHITE);
+
+            // Diamonds
+            drawList.Text(LAYER_HUD, "DIAMONDS:", 20, 30, 20, WHITE);
+            for(int i=0; i<5; i++) {
+                Color dCol = (i < snap.diamondsLeft) ? DARKGRAY : COL_DIAMOND;
+                drawList.Rect(LAYER_HUD, 140 + (i*30), 25, 20, 30, dCol);
+                drawList.RectLines(LAYER_HUD, 140 + (i*30), 25, 20, 30, WHITE);
+            }
+
+            // Stamina
+            drawList.Text(LAYER_HUD, "STAMINA:", 350, 30, 20, WHITE);
+            drawList.Rect(LAYER_HUD, 460, 25, 200, 30, DARKGRAY);
+            drawList.Rect(LAYER_HUD, 460, 25, (int)(snap.stamina * 2.0f), 30, COL_PLAYER);
+            drawList.RectLines(LAYER_HUD, 460, 25, 200, 30, WHITE);
+
+            // Right Info
+            drawList.Text(LAYER_HUD, "MOVE: ARROWS", 720, 10, 10, LIGHTGRAY);
+            drawList.Text(LAYER_HUD, "RUN: SHIFT", 720, 28, 10, LIGHTGRAY);
+            drawList.Text(LAYER_HUD, "DOOR: E", 720, 46, 10, LIGHTGRAY);
+            if (snap.coop) {
+                drawList.Text(LAYER_HUD, TextFormat("CO-OP RTT: %.0f ms", snap.coopRttMs), 720, 64, 10, snap.desynced ? RED : LIGHTGRAY);
+            } else {
+                drawList.Text(LAYER_HUD, "REWIND: BKSP", 720, 64, 10, LIGHTGRAY);
+            }
+
+            if (snap.ghostTimer > 0)
+                drawList.Text(LAYER_HUD, TextFormat("GHOST: %.1f", snap.ghostTimer), 820, 30, 20, COL_DIAMOND);
+
+            if (snap.freezeTimer > 0) {
+                 drawList.Text(LAYER_HUD, TextFormat("FROZEN! %.1f", snap.freezeTimer), SCREEN_WIDTH/2 - 60, SCREEN_HEIGHT/2 - 50, 40, RED);
+            }
+            if (snap.lockedExit) {
+                 drawList.Text(LAYER_HUD, "LOCKED!", SCREEN_WIDTH/2 - 50, SCREEN_HEIGHT - 60, 20, RED);
+            }
+        }
+        else if (snap.state == QUIZ) {
+            drawList.Rect(LAYER_SCREEN, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, {0, 0, 0, 220});
+            const QuestionLayout& q = questionLayouts[snap.questionId];
+            Rectangle box = { SCREEN_WIDTH/2.0f - 300, SCREEN_HEIGHT/2.0f - q.boxHeight/2, 600, q.boxHeight };
+            drawList.Rounded(LAYER_SCREEN, box, 0.1f, 10, COL_UI_PANEL);
+            drawList.RoundedLines(LAYER_SCREEN, box, 0.1f, 10, WHITE);
+
+            drawList.Text(LAYER_SCREEN, "BONUS QUESTION", box.x + 180, box.y + 30, 30, COL_NUGGET);
+            DrawTextLayout(LAYER_SCREEN, q.text, box.x + 50, box.y + 100, WHITE);
+            for (int i = 0; i < 3; i++) DrawTextLayout(LAYER_SCREEN, q.options[i], box.x + 50, box.y + q.optionY[i], WHITE);
+            if (snap.quizPlayer == localPlayer) drawList.Text(LAYER_SCREEN, "Press 1, 2, or 3", box.x + 220, box.y + q.promptY, 20, LIGHTGRAY);
+            else drawList.Text(LAYER_SCREEN, "Your partner is answering...", box.x + 160, box.y + q.promptY, 20, COL_PARTNER);
+        }
+        else if (snap.state == VICTORY) {
+            drawList.Rect(LAYER_SCREEN, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, Fade(GREEN, 0.9f));
+            drawList.Text(LAYER_SCREEN, "HEIST SUCCESSFUL!", SCREEN_WIDTH/2 - 180, SCREEN_HEIGHT/2 - 20, 40, WHITE);
+            drawList.Text(LAYER_SCREEN, "[ENTER] to Play Again", SCREEN_WIDTH/2 - 120, SCREEN_HEIGHT/2 + 40, 20, BLACK);
+        }
+        else if (snap.state == GAME_OVER) {
+            drawList.Rect(LAYER_SCREEN, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, Fade(MAROON, 0.9f));
+            drawList.Text(LAYER_SCREEN, "BUSTED!", SCREEN_WIDTH/2 - 80, SCREEN_HEIGHT/2 - 20, 40, WHITE);
+            drawList.Text(LAYER_SCREEN, "[ENTER] to Retry", SCREEN_WIDTH/2 - 90, SCREEN_HEIGHT/2 + 40, 20, LIGHTGRAY);
+        }
+    }
+
+    // The game is frozen for good once the co-op session is over
+    if (snap.coopEnded) {
+        drawList.Rect(LAYER_SCREEN, 0, SCREEN_HEIGHT/2 - 60, SCREEN_WIDTH, 120, {0, 0, 0, 220});
+        drawList.Text(LAYER_SCREEN, "CO-OP ENDED", SCREEN_WIDTH/2 - 110, SCREEN_HEIGHT/2 - 40, 40, RED);
+        drawList.Text(LAYER_SCREEN, TextFormat("%s. Close the window to quit.", snap.coopEnded), 40, SCREEN_HEIGHT/2 + 20, 20, LIGHTGRAY);
+    }
+}
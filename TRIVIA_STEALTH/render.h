@@ -0,0 +1,235 @@
+// Render thread side: text layout, particles, the animation clock, GPU resources
+// and the functions that draw a render snapshot.
+#pragma once
+
+#include "sim_thread.h"
+#include "draw_list.h"
+
+//  Render Stats 
+// F3 overlay: the last frame's counters per phase and where the batch broke
+void DrawRenderStatsOverlay(double drawMs, long long framesDrawn, long long framesSkipped);
+
+//  Text Layout 
+
+// One wrapped line: a byte span into TextLayout::text plus its measured width
+struct TextLine {
+    int start;
+    int length;
+    float width;
+};
+
+// Shaped text, built once. Lines are stored back to back with a '\0' after each,
+// so drawing hands every span straight to raylib with no copying or measuring.
+struct TextLayout {
+    string text;
+    vector<TextLine> lines;
+    float fontSize = 0;
+    float spacing = 0;
+    float lineHeight = 0;
+    float width = 0;
+    float Height() const { return lines.size() * lineHeight; }
+};
+
+const float QUIZ_TEXT_WIDTH = 500.0f;
+
+// Shapes the whole bank up front so showing a question never allocates
+void PrepareQuestionLayouts();
+
+//  Particles 
+// Every particle lives in one fixed pool stored as separate arrays per field, so
+// the update is a few straight loops over floats that the compiler turns into SIMD.
+// Dead particles are swap-removed to keep the live ones packed at the front, and
+// all of them are drawn as one dynamic mesh in a single draw call. Nothing is
+// allocated after Init; bursts past the capacity are simply cut short.
+const int PARTICLE_CAPACITY = 100000;
+const int PARTICLE_BLOCK = 8;     // Update stride; the capacity is a multiple of it
+static_assert(PARTICLE_CAPACITY % PARTICLE_BLOCK == 0, "particle pool must be whole blocks");
+const int PARTICLE_VERTICES = 6; // Two triangles; no index buffer, so no 16-bit vertex limit
+const float PARTICLE_DRAG = 2.5f;     // Share of velocity lost per second
+const float PARTICLE_GRAVITY = 120.0f; // Pixels per second squared, downwards
+
+class ParticleSystem {
+public:
+    // CPU side of the mesh, once at startup
+    void Init() {
+        mesh.vertexCount = PARTICLE_CAPACITY * PARTICLE_VERTICES;
+        mesh.triangleCount = PARTICLE_CAPACITY * 2;
+        mesh.vertices = (float*)MemAlloc(mesh.vertexCount * 3 * sizeof(float));
+        mesh.colors = (unsigned char*)MemAlloc(mesh.vertexCount * 4);
+    }
+
+    void Upload() {
+        mesh.vertexCount = PARTICLE_CAPACITY * PARTICLE_VERTICES;
+        UploadMesh(&mesh, true);
+        uploaded = true;
+    }
+
+    void Unload() {
+        if (uploaded) UnloadMesh(mesh); // Frees the CPU arrays too
+        else {
+            MemFree(mesh.vertices);
+            MemFree(mesh.colors);
+        }
+        mesh = {};
+        uploaded = false;
+    }
+
+    // count particles flung out of a point in random directions
+    void Burst(Vector2 at, int count, Color color, float speed, float lifetime, float size) {
+        uint32_t packed = (uint32_t)color.r | (uint32_t)color.g << 8 | (uint32_t)color.b << 16;
+        count = min(count, PARTICLE_CAPACITY - live);
+        for (int k = 0; k < count; k++) {
+            int i = live++;
+            float angle = (r.Next() >> 8) * (2.0f * PI / 16777216.0f);
+            float v = speed * (0.3f + 0.7f * (r.Next() >> 8) / 16777216.0f);
+            float t = lifetime * (0.6f + 0.4f * (r.Next() >> 8) / 16777216.0f);
+            px[i] = at.x;
+            py[i] = at.y;
+            vx[i] = cosf(angle) * v;
+            vy[i] = sinf(angle) * v;
+            life[i] = t;
+            fade[i] = 255.0f / t;
+            halfSize[i] = size * 0.5f;
+            rgb[i] = packed;
+        }
+        spawned += count;
+    }
+
+    void Update(float dt) {
+        float keep = max(0.0f, 1.0f - PARTICLE_DRAG * dt);
+        float fall = PARTICLE_GRAVITY * dt;
+        // Whole blocks of PARTICLE_BLOCK: no remainder loop, so it vectorizes even at -O2.
+        // Slots past the live count are dead and only ever overwritten by Burst.
+        int n = live;
+        for (int block = 0; block < n; block += PARTICLE_BLOCK) {
+            for (int k = 0; k < PARTICLE_BLOCK; k++) {
+                int i = block + k;
+                px[i] += vx[i] * dt;
+                py[i] += vy[i] * dt;
+                vx[i] *= keep;
+                vy[i] = vy[i] * keep + fall;
+                life[i] -= dt;
+            }
+        }
+
+        // Back to front, so the particle moved into a hole has already been checked
+        for (int i = n - 1; i >= 0; i--) {
+            if (life[i] > 0) continue;
+            int last = --live;
+            px[i] = px[last];
+            py[i] = py[last];
+            vx[i] = vx[last];
+            vy[i] = vy[last];
+            life[i] = life[last];
+            fade[i] = fade[last];
+            halfSize[i] = halfSize[last];
+            rgb[i] = rgb[last];
+        }
+    }
+
+    // Fills the mesh arrays for the live particles; fading out over their last stretch
+    void Build() {
+        float* v = mesh.vertices;
+        uint32_t* c = (uint32_t*)mesh.colors;
+        for (int i = 0; i < live; i++) {
+            float x0 = px[i] - halfSize[i], x1 = px[i] + halfSize[i];
+            float y0 = py[i] - halfSize[i], y1 = py[i] + halfSize[i];
+            float* q = v + (size_t)i * PARTICLE_VERTICES * 3;
+            q[0] = x0; q[1] = y0; q[2] = 0;
+            q[3] = x0; q[4] = y1; q[5] = 0;
+            q[6] = x1; q[7] = y1; q[8] = 0;
+            q[9] = x0; q[10] = y0; q[11] = 0;
+            q[12] = x1; q[13] = y1; q[14] = 0;
+            q[15] = x1; q[16] = y0; q[17] = 0;
+            uint32_t alpha = (uint32_t)min(255.0f, life[i] * fade[i] * 2.0f);
+            uint32_t color = rgb[i] | alpha << 24; // Little-endian RGBA
+            uint32_t* qc = c + (size_t)i * PARTICLE_VERTICES;
+            for (int k = 0; k < PARTICLE_VERTICES; k++) qc[k] = color;
+        }
+    }
+
+    // Streams this frame's vertices to the GPU and records the one mesh draw
+    void Draw() {
+        if (!uploaded || live == 0) return;
+        Build();
+        int vertices = live * PARTICLE_VERTICES;
+        UpdateMeshBuffer(mesh, 0, mesh.vertices, vertices * 3 * sizeof(float), 0);
+        UpdateMeshBuffer(mesh, 3, mesh.colors, vertices * 4, 0);
+        mesh.vertexCount = vertices;
+        mesh.triangleCount = live * 2;
+        drawList.Mesh(LAYER_PARTICLES, mesh);
+    }
+
+    int Live() const { return live; }
+    long long spawned = 0;
+
+private:
+    float px[PARTICLE_CAPACITY];
+    float py[PARTICLE_CAPACITY];
+    float vx[PARTICLE_CAPACITY];
+    float vy[PARTICLE_CAPACITY];
+    float life[PARTICLE_CAPACITY];     // Seconds left
+    float fade[PARTICLE_CAPACITY];     // 255 / lifetime, turns life into alpha
+    float halfSize[PARTICLE_CAPACITY];
+    uint32_t rgb[PARTICLE_CAPACITY];   // Packed colour without alpha
+    int live = 0;
+    MazeRng r{0x51a5u};                // Own dice: effects must not touch the game's rng
+    Mesh mesh = {};
+    bool uploaded = false;
+};
+
+extern ParticleSystem particles;
+
+// Turns the effects the rules queued into bursts and moves everything on
+void UpdateParticles(float dt);
+
+//  Animation Clock 
+// Every shared animation curve is evaluated once per frame, here; the draw code only
+// reads the results. Pickups differ by a phase fixed at spawn (AnimPhase), applied to
+// a whole chunk at once with sin(a + p) = sin a cos p + cos a sin p, so no pickup
+// needs a sin call of its own.
+struct AnimClock {
+    float pickupSpin = 0;    // Degrees
+    float pulseSin = 0;      // sin and cos of the shared pulse angle
+    float pulseCos = 1;
+    float exitAlpha = 0;     // 0-1, the open exit's outline
+    float menuSpin[2] = {};  // Degrees, the two background diamonds
+    float menuPulse = 0;     // 0-1, the start prompt
+
+    void Tick(double now) {
+        double pulse = 5.0 * now;
+        pulseSin = (float)sin(pulse);
+        pulseCos = (float)cos(pulse);
+        pickupSpin = (float)fmod(100.0 * now, 360.0);
+        exitAlpha = (float)(sin(3.0 * now) + 1.0) / 2.0f;
+        menuSpin[0] = (float)fmod(10.0 * now, 360.0);
+        menuSpin[1] = (float)fmod(-15.0 * now, 360.0);
+        menuPulse = (pulseSin + 1.0f) / 2.0f;
+    }
+
+    // Per pickup in a chunk: glow scale (0.5-1.5) and rotation, shifted by its phase
+    void PickupBatch(const AnimPhase* phase, int n, float* scale, float* spin) const {
+        for (int i = 0; i < n; i++) {
+            scale[i] = (pulseSin * phase[i].cos + pulseCos * phase[i].sin + 2.0f) * 0.5f;
+            spin[i] = pickupSpin + phase[i].degrees;
+        }
+    }
+};
+
+extern AnimClock animClock;
+
+// . Drawing Functions .
+
+// GPU resources follow the snapshots: a new level serial uploads that level's walls
+// (and lets the simulation retire the previous level), and the fog window is sent
+// again whenever a newer tick arrives.
+extern Material meshMaterial; // Wall meshes are drawn with raylib's default material
+
+void SyncRenderResources(const RenderSnapshot& snap);
+
+void UnloadRenderResources();
+
+// The playfield under the UI, in every state but the menu screens
+void DrawWorld(const RenderSnapshot& snap);
+
+void DrawUI(const RenderSnapshot& snap);
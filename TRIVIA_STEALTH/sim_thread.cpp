@@ -0,0 +1,94 @@
+#include "sim_thread.h"
+
+//  Render Snapshots 
+// Scrolls the playfield so the player stays centred on maps larger than the window
+void UpdateGameCamera() {
+    float viewW = SCREEN_WIDTH / gameCamera.zoom;
+    float viewH = (SCREEN_HEIGHT - UI_HEIGHT) / gameCamera.zoom;
+    float worldW = (float)level->grid.cols * TILE_SIZE;
+    float worldH = (float)level->grid.rows * TILE_SIZE;
+
+    const Position* p = level->world.Get<Position>(level->players[localPlayer]);
+    if (!p) return;
+    float tx = p->x * TILE_SIZE + TILE_SIZE / 2.0f - viewW / 2.0f;
+    float ty = p->y * TILE_SIZE + TILE_SIZE / 2.0f - viewH / 2.0f;
+    gameCamera.target.x = (worldW <= viewW) ? 0.0f : std::clamp(tx, 0.0f, worldW - viewW);
+    gameCamera.target.y = (worldH <= viewH) ? 0.0f : std::clamp(ty, 0.0f, worldH - viewH);
+    gameCamera.offset = { 0.0f, 0.0f };
+}
+
+void CaptureRenderSnapshot(RenderSnapshot& s) {
+    s.tick = simTick;
+    s.state = currentState;
+    s.level = level;
+    s.levelSerial = levelHandoff.serial;
+    s.coopEnded = lockstep.Failed() ? lockstep.Failure() : nullptr;
+    s.loading = resetPending;
+    s.viewCols = s.viewRows = 0;
+    s.thiefCount = s.pickupCount = s.guardCount = 0;
+    if (!level || currentState == MENU || currentState == HELP) return;
+
+    UpdateGameCamera();
+    UpdateFogOfWar();
+    s.camera = gameCamera;
+
+    // The window: covers the view wherever the camera is clamped, clipped to the map
+    const TileGrid& grid = level->grid;
+    s.viewCols = min(VIEW_COLS, grid.cols);
+    s.viewRows = min(VIEW_ROWS, grid.rows);
+    s.viewX = std::clamp((int)(gameCamera.target.x / TILE_SIZE), 0, grid.cols - s.viewCols);
+    s.viewY = std::clamp((int)(gameCamera.target.y / TILE_SIZE), 0, grid.rows - s.viewRows);
+    for (int j = 0; j < s.viewRows; j++) {
+        int y = s.viewY + j;
+        for (int i = 0; i < s.viewCols; i++) {
+            int x = s.viewX + i;
+            int k = j * s.viewCols + i;
+            s.tiles[k] = (unsigned char)grid[y][x];
+            s.noise[k] = (unsigned char)min(255.0f, noise.Sample(x, y) * (255.0f / NOISE_LOUDNESS));
+            const unsigned char* px = &level->fog.pixels[2 * ((size_t)y * grid.cols + x)];
+            s.fog[2 * k] = px[0];
+            s.fog[2 * k + 1] = px[1];
+        }
+    }
+
+    World& world = level->world;
+    world.Each<Position, Controlled>([&](int n, const EntityHandle* ids, Position* pos, Controlled* controlled) {
+        for (int i = 0; i < n && s.thiefCount < MAX_PLAYERS; i++) {
+            s.thieves[s.thiefCount++] = { (int16_t)pos[i].x, (int16_t)pos[i].y, controlled[i].player,
+                                          world.Has<Invisibility>(ids[i]), world.Has<Freeze>(ids[i]) };
+        }
+    });
+    world.Each<Position, Pickup, AnimPhase>([&](int n, const EntityHandle*, Position* pos, Pickup* pickup, AnimPhase* phase) {
+        for (int i = 0; i < n && s.pickupCount < MAX_ENTITIES; i++) {
+            s.pickupPhases[s.pickupCount] = phase[i];
+            s.pickups[s.pickupCount++] = { (int16_t)pos[i].x, (int16_t)pos[i].y, pickup[i].kind };
+        }
+    });
+    world.Each<Position, Speed, Guard>([&](int n, const EntityHandle*, Position* pos, Speed* speed, Guard* guard) {
+        for (int i = 0; i < n && s.guardCount < MAX_ENTITIES; i++) {
+            if (!IsTileVisible(pos[i].x, pos[i].y)) continue; // Out of sight: not even drawn under the fog
+            bool searching = guard[i].mode == GUARD_SEARCH || guard[i].mode == GUARD_INVESTIGATE;
+            s.guards[s.guardCount++] = { (int16_t)pos[i].x, (int16_t)pos[i].y, speed[i].delay > 0.45f, searching };
+        }
+    });
+
+    EntityHandle self = level->players[localPlayer];
+    const Position* pos = world.Get<Position>(self);
+    const Stamina* stamina = world.Get<Stamina>(self);
+    const Invisibility* ghost = world.Get<Invisibility>(self);
+    const Freeze* freeze = world.Get<Freeze>(self);
+    s.diamondsLeft = level->diamondsLeft;
+    s.stamina = stamina ? stamina->value : 0;
+    s.ghostTimer = ghost ? ghost->timer : 0;
+    s.freezeTimer = freeze ? freeze->timer : 0;
+    s.lockedExit = pos && grid[pos->y][pos->x] == TILE_EXIT && level->diamondsLeft > 0;
+    s.questionId = currentQuestionId;
+    s.quizPlayer = quizPlayer;
+    s.coop = lockstep.Active() && !lockstep.Failed();
+    s.coopRttMs = s.coop ? lockstep.RttMedian() * 1000.0f : 0;
+    s.desynced = s.coop && lockstep.desyncs > 0;
+
+}
+
+//  Simulation Thread 
+SimThread simThread;
@@ -0,0 +1,143 @@
+// Simulation thread and the render snapshots it publishes to the render thread.
+#pragma once
+
+#include "lockstep.h"
+
+//  Render Snapshots 
+// Everything the render thread draws, copied out of the level once per tick by the
+// simulation thread: the camera, the tiles, noise and fog around it, the entities in
+// sight and the HUD values. Fixed size, so publishing one is a plain fill of a slot.
+// The window is clipped to the map but otherwise always VIEW_COLS x VIEW_ROWS, so
+// its size only changes with the level.
+const int VIEW_COLS = SCREEN_WIDTH / TILE_SIZE + 2;
+const int VIEW_ROWS = (SCREEN_HEIGHT - UI_HEIGHT) / TILE_SIZE + 2;
+
+struct ThiefView {
+    int16_t x, y;
+    uint8_t player;
+    bool invisible;
+    bool frozen;
+};
+
+struct PickupView {
+    int16_t x, y;
+    PickupKind kind;
+};
+
+struct GuardView {
+    int16_t x, y;
+    bool slow;
+    bool searching;
+};
+
+struct RenderSnapshot {
+    long long tick;
+    GameState state;
+    Level* level;          // Only for its wall meshes, which never change after LoadLevel
+    uint32_t levelSerial;
+    Camera2D camera;
+
+    // Tile window around the camera
+    int viewX, viewY, viewCols, viewRows;
+    unsigned char tiles[VIEW_ROWS * VIEW_COLS];
+    unsigned char noise[VIEW_ROWS * VIEW_COLS];   // Sprint noise heard, 255 = NOISE_LOUDNESS
+    unsigned char fog[2 * VIEW_ROWS * VIEW_COLS]; // Overlay pixels, as in FogOfWar
+
+    int thiefCount, pickupCount, guardCount;
+    ThiefView thieves[MAX_PLAYERS];
+    PickupView pickups[MAX_ENTITIES];
+    AnimPhase pickupPhases[MAX_ENTITIES]; // Apart, so the animation runs over them in one batch
+    GuardView guards[MAX_ENTITIES];       // Only those the local thief can see
+
+    // HUD, for the local thief
+    int diamondsLeft;
+    float stamina;
+    float ghostTimer;  // 0 when not a ghost
+    float freezeTimer; // 0 when not frozen
+    bool lockedExit;   // Standing on the exit before it opens
+    int questionId;
+    int quizPlayer;
+    bool coop;
+    float coopRttMs;
+    bool desynced;
+    const char* coopEnded; // Why the co-op session ended, or nullptr
+    bool loading;          // A run was started and waits for its level
+};
+
+void CaptureRenderSnapshot(RenderSnapshot& s);
+
+//  Simulation Thread 
+// The rules run here on a fixed step, apart from drawing: a slow frame no longer
+// delays a tick and a long tick no longer delays a frame. Input arrives through the
+// input buffer's ring, effects leave through the effect queue, and each tick ends by
+// publishing a render snapshot. No raylib call is made on this thread; its clock is
+// started from the render thread's GetTime so input stamps and ticks share a base.
+const float SIM_DT = 1.0f / 60.0f;
+const int SIM_MAX_BEHIND = 15; // Ticks; further behind (debugger, suspend) it skips ahead instead of racing
+
+class SimThread {
+public:
+    void Start(double now) {
+        clockBase = now;
+        clockStart = std::chrono::steady_clock::now();
+        levelHandoff.rendering = true;
+        CaptureRenderSnapshot(snapshots.Back());
+        snapshots.Publish();
+        quit = false;
+        worker = std::thread([this] { Run(); });
+    }
+
+    // Parked levels stay parked: the render thread still has to release its GPU copy
+    void Stop() {
+        quit = true;
+        if (worker.joinable()) worker.join();
+        levelHandoff.rendering = false;
+    }
+
+    bool Running() const { return worker.joinable(); }
+
+    // Render thread: the newest snapshot, valid until the next call
+    const RenderSnapshot& Latest() { return snapshots.Acquire(); }
+
+    double Now() const {
+        return clockBase + std::chrono::duration<double>(std::chrono::steady_clock::now() - clockStart).count();
+    }
+
+    std::atomic<long long> ticks{0};
+    std::atomic<long long> skips{0};
+
+private:
+    void Run() {
+        allocPhase = allocTrack ? ALLOC_SIM : ALLOC_NONE;
+        const auto step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(SIM_DT));
+        auto next = std::chrono::steady_clock::now();
+        while (!quit.load(std::memory_order_relaxed)) {
+            double now = Now();
+            if (lockstep.Active()) StepLockstep(now);
+            else StepGame(inputBuffer.Consume(now), SIM_DT);
+            if (statePublisher.Active()) statePublisher.Beat();
+            levelHandoff.Collect();
+            CaptureRenderSnapshot(snapshots.Back());
+            snapshots.Publish();
+            ticks.fetch_add(1, std::memory_order_relaxed);
+
+            next += step;
+            auto t = std::chrono::steady_clock::now();
+            if (t > next + step * SIM_MAX_BEHIND) {
+                next = t;
+                skips.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                std::this_thread::sleep_until(next);
+            }
+        }
+        allocPhase = ALLOC_NONE;
+    }
+
+    TripleBuffer<RenderSnapshot> snapshots;
+    std::thread worker;
+    std::atomic<bool> quit{false};
+    double clockBase = 0;
+    std::chrono::steady_clock::time_point clockStart;
+};
+
+extern SimThread simThread;
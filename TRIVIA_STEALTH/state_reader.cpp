@@ -0,0 +1,128 @@
+// Prints the live state stream of a running game started with --publish-state.
+//
+//   state_reader [--every N] [--count N] [--name NAME]
+//
+// Polls the shared ring without ever writing to it, so the game never waits on a
+// reader. Records the reader was too slow to copy are reported as overruns. Stops
+// when the game closes the stream, or when its heartbeat stops because it died.
+#include "state_stream.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <chrono>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Same order as GameState in common.h
+const char* const STATE_NAMES[] = { "MENU", "PLAYING", "QUIZ", "FROZEN", "GAME_OVER", "VICTORY", "HELP" };
+
+// Maps the stream read-only. An object smaller than this build's layout (another
+// version, or a half-created one) is refused: touching past its end raises SIGBUS.
+const StateStream* OpenStream(const char* name, bool& tooSmall) {
+    tooSmall = false;
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(StateStream)) {
+        tooSmall = true;
+        close(fd);
+        return nullptr;
+    }
+    void* memory = mmap(nullptr, sizeof(StateStream), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    return memory == MAP_FAILED ? nullptr : (const StateStream*)memory;
+}
+
+uint64_t NowMs() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+}
+
+// Copies record n if it is still in its slot. Returns false if it has been overwritten.
+bool ReadRecord(const StateStream* stream, uint64_t n, StateRecord& out) {
+    const StreamSlot& slot = stream->slots[n % STREAM_SLOTS];
+    uint64_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before != 2 * n) return false;
+    memcpy(&out, &slot.record, sizeof(out));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == before;
+}
+
+void PrintRecord(const StateRecord& r) {
+    const char* state = (r.state >= 0 && r.state < 7) ? STATE_NAMES[r.state] : "?";
+    printf("%8llu %-9s diamonds %d", (unsigned long long)r.tick, state, r.diamondsLeft);
+    for (int p = 0; p < r.playerCount && p < STREAM_MAX_PLAYERS; p++) {
+        const StreamPlayer& pl = r.players[p];
+        printf(" | P%d (%d,%d) stamina %.0f", p + 1, pl.x, pl.y, pl.stamina);
+        if (pl.ghostTimer > 0) printf(" ghost %.1f", pl.ghostTimer);
+        if (pl.freezeTimer > 0) printf(" frozen %.1f", pl.freezeTimer);
+    }
+    printf(" | guards");
+    for (int g = 0; g < r.guardCount && g < STREAM_MAX_GUARDS; g++) printf(" (%d,%d)", r.guards[g].x, r.guards[g].y);
+    printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* name = STATE_STREAM_NAME;
+    long long every = 1;
+    long long limit = -1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--every") == 0 && i + 1 < argc) every = std::max(1LL, atoll(argv[++i]));
+        else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) limit = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--name") == 0 && i + 1 < argc) name = argv[++i];
+    }
+
+    bool tooSmall = false;
+    const StateStream* stream = OpenStream(name, tooSmall);
+    if (!stream) {
+        if (tooSmall) printf("State stream at %s has a different layout\n", name);
+        else printf("No state stream at %s; start the game with --publish-state\n", name);
+        return 1;
+    }
+    if (stream->magic != STATE_STREAM_MAGIC || stream->version != STATE_STREAM_VERSION ||
+        stream->recordBytes != sizeof(StateRecord) || stream->slotCount != STREAM_SLOTS) {
+        printf("State stream at %s has a different layout\n", name);
+        return 1;
+    }
+
+    // Start from the newest record rather than replaying the whole ring
+    uint64_t next = stream->head.load(std::memory_order_acquire) + 1;
+    long long read = 0;
+    long long overruns = 0;
+    while (limit < 0 || read < limit) {
+        uint64_t head = stream->head.load(std::memory_order_acquire);
+        if (next > head) {
+            if (!stream->writerAlive.load(std::memory_order_acquire)) break;
+            uint64_t beat = stream->heartbeatMs.load(std::memory_order_relaxed);
+            uint64_t now = NowMs();
+            if (now > beat && now - beat > STREAM_STALE_MS) {
+                printf("The game stopped without closing the stream\n");
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        // Too far behind: everything older than one ring is gone
+        if (head - next >= STREAM_SLOTS) {
+            uint64_t skipTo = head - STREAM_SLOTS + 1;
+            overruns += (long long)(skipTo - next);
+            next = skipTo;
+        }
+        StateRecord record;
+        if (!ReadRecord(stream, next, record)) {
+            overruns++; // Overwritten while we were copying it
+            next++;
+            continue;
+        }
+        if (record.tick % every == 0) PrintRecord(record);
+        read++;
+        next++;
+    }
+    printf("Read %lld records, %lld lost to overruns\n", read, overruns);
+    munmap((void*)stream, sizeof(StateStream));
+    return 0;
+}
@@ -0,0 +1,64 @@
+// Shared-memory layout of the live state stream (--publish-state). The game is the
+// only writer; any number of readers map the same object read-only.
+//
+// Record n (counting from 1) lives in slot n % STREAM_SLOTS. The slot's sequence is
+// 2n+1 while the game writes it and 2n once it is complete, so a reader that sees the
+// same even value before and after copying has a whole record. A reader that falls
+// more than STREAM_SLOTS records behind finds newer sequences and knows it overran.
+//
+// The game refreshes heartbeatMs (steady clock, which is system-wide) every tick. A
+// writer that was killed never clears writerAlive, so readers go by the heartbeat.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+const char* const STATE_STREAM_NAME = "/trivia_stealth_state";
+const uint32_t STATE_STREAM_MAGIC = 0x31535354; // "TSS1"
+const uint32_t STATE_STREAM_VERSION = 2;
+const int STREAM_MAX_PLAYERS = 2;
+const int STREAM_MAX_GUARDS = 16;
+const uint32_t STREAM_SLOTS = 1024;
+const uint64_t STREAM_STALE_MS = 2000; // A heartbeat this old means the game is gone
+
+struct StreamPlayer {
+    int16_t x, y;
+    float stamina;
+    float ghostTimer;  // Seconds of invisibility left, 0 when visible
+    float freezeTimer; // Seconds frozen left, 0 when free
+};
+
+struct StreamGuard {
+    int16_t x, y;
+};
+
+struct StateRecord {
+    uint64_t tick;        // Ticks published since the game started
+    int32_t state;        // GameState: MENU, PLAYING, QUIZ, FROZEN, GAME_OVER, VICTORY, HELP
+    int32_t diamondsLeft;
+    uint8_t playerCount;
+    uint8_t guardCount;
+    uint16_t reserved;
+    StreamPlayer players[STREAM_MAX_PLAYERS];
+    StreamGuard guards[STREAM_MAX_GUARDS];
+};
+
+struct StreamSlot {
+    std::atomic<uint64_t> sequence;
+    StateRecord record;
+};
+
+struct StateStream {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t recordBytes;
+    std::atomic<uint32_t> writerAlive; // Cleared when the game closes the stream
+    std::atomic<uint64_t> heartbeatMs; // Writer's steady clock at its last tick
+    alignas(64) std::atomic<uint64_t> head; // Newest complete record
+    alignas(64) StreamSlot slots[STREAM_SLOTS];
+};
+
+static_assert(std::is_trivially_copyable_v<StateRecord>, "records are copied as raw bytes");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the stream is shared between processes");
@@ -0,0 +1,66 @@
+// Single-producer single-consumer handoff between the render and simulation threads.
+#pragma once
+
+#include "common.h"
+
+//  Thread Handoff 
+// Lock-free pieces between the render (main) thread and the simulation thread.
+// Each has exactly one writer and one reader, so plain acquire/release atomics do.
+
+// Fixed ring for one producer and one consumer. A full ring refuses the new item:
+// only the consumer may move the read index.
+template <typename T, int N>
+class SpscRing {
+    static_assert((N & (N - 1)) == 0, "capacity must be a power of two");
+
+public:
+    bool Push(const T& item) {
+        uint32_t w = writeIndex.load(std::memory_order_relaxed);
+        if (w - readIndex.load(std::memory_order_acquire) == N) return false;
+        items[w & (N - 1)] = item;
+        writeIndex.store(w + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Pop(T& out) {
+        uint32_t r = readIndex.load(std::memory_order_relaxed);
+        if (r == writeIndex.load(std::memory_order_acquire)) return false;
+        out = items[r & (N - 1)];
+        readIndex.store(r + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T items[N];
+    alignas(64) std::atomic<uint32_t> writeIndex{0}; // Apart, so the two sides do not share a cache line
+    alignas(64) std::atomic<uint32_t> readIndex{0};
+};
+
+// Latest-value handoff: the writer fills its back slot and swaps it with the middle
+// one; the reader swaps the middle one for its front slot when a newer value is
+// there. Neither side ever waits, and the reader always gets a whole value.
+template <typename T>
+class TripleBuffer {
+public:
+    T& Back() { return slots[back]; }
+
+    void Publish() {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // The newest published value; stays valid and unchanged until the next call
+    const T& Acquire() {
+        if (middle.load(std::memory_order_relaxed) & FRESH) {
+            front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        }
+        return slots[front];
+    }
+
+private:
+    static const uint32_t FRESH = 4;
+    static const uint32_t INDEX = 3;
+    T slots[3] = {};
+    uint32_t back = 0;                 // Writer only
+    uint32_t front = 1;                // Reader only
+    alignas(64) std::atomic<uint32_t> middle{2};
+};